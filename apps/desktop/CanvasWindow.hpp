@@ -1,17 +1,22 @@
 #ifndef CANVASWINDOW_HPP
 #define CANVASWINDOW_HPP
 #include "core/input/InputManager.hpp"
+#include "core/input/InputRecorder.hpp"
 #include "core/plugins/PluginManager.hpp"
 #include "core/recognition/ModelRunner.hpp"
+#include "core/recognition/ModelWarmup.hpp"
 #include "core/recognition/RecognizerRouter.hpp"
 #include "core/recognition/GestureRecognizer.hpp"
+#include "core/recognition/GlyphRasterizer.hpp"
 #include "core/recognition/TrocrDecoder.hpp"
 #include "utils/SymbolicParser.hpp"
 #include "utils/Logger.hpp"
+#include "Stroke.hpp"
 #include <QCoreApplication>
 #include <QClipboard>
 #include <QDir>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QGuiApplication>
 #include <QJsonArray>
@@ -22,15 +27,20 @@
 #include <QPainter>
 #include <QPen>
 #include <QPainterPath>
+#include <QPaintEvent>
+#include <QRegion>
 #include <QPushButton>
 #include <QLabel>
 #include <QColor>
 #include <QCloseEvent>
 #include <QHideEvent>
+#include <QImage>
 #include <QResizeEvent>
+#include <QScreen>
 #include <QShowEvent>
 #include <QSize>
 #include <QShortcut>
+#include <QThreadPool>
 #include <QTimer>
 #include <QInputDialog>
 #include <QLineEdit>
@@ -51,25 +61,35 @@
 #include <QString>
 #include <QTransform>
 #include <QWidget>
+#include <QWindow>
 #include <algorithm>
+#include <atomic>
+#include <optional>
 #include <vector>
 #include <random>
 #include <deque>
 #include <unordered_map>
+#include <map>
 #include <memory>
 #include <cstdint>
 
+// Rates are per 10 ms, the frame tick they were tuned at; onFrame() scales
+// them by the measured frame interval.
 struct CanvasWindowOptions {
   float rippleGrowthRate{2.f};
   float rippleMaxRadius{80.f};
   QColor rippleColor{255, 251, 224, 150};
   int strokeWidth{3};
   QColor strokeColor{255, 251, 224};
-  float fadeRate{0.005f};
+  float fadeRate{0.005f}; // 0 keeps finished strokes on screen
   QColor backgroundTint{34, 34, 34, 120};
   QColor detectionColor{255, 255, 255, 102};
   bool fullscreen{false};
   bool cursorAnimation{true};
+  QString recordPath; // raw input log for symbolcast-replay; empty = off
+  // Queue mouse moves and process them once per frame in onFrame() instead
+  // of running the whole pipeline for every event.
+  bool coalesceMoves{false};
 };
 
 class CanvasWindow : public QWidget {
@@ -161,13 +181,26 @@ public:
     m_idleTimer = new QTimer(this);
     connect(m_idleTimer, &QTimer::timeout, this, [this] { m_label->show(); });
     m_idleTimer->setInterval(5000);
+    m_idleTimer->setSingleShot(true);
     m_idleTimer->start();
 
+    // Frame timer; runs only while something animates (see wakeFrameTimer()).
     m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
     connect(m_timer, &QTimer::timeout, this,
             QOverload<>::of(&CanvasWindow::onFrame));
-    // higher refresh rate for smoother drawing
-    m_timer->start(10);
+    m_frameClock.start();
+    // Frame and wakeup rates are only measured for DEBUG logs. They are
+    // reported by a slow timer of their own, because the frame timer is
+    // stopped whenever the canvas is idle.
+    if (sc::globalLogLevel() == sc::LogLevel::Debug) {
+      m_frameWindow.start();
+      QCoreApplication::instance()->installEventFilter(this);
+      auto *report = new QTimer(this);
+      report->setTimerType(Qt::VeryCoarseTimer);
+      connect(report, &QTimer::timeout, this, [this] { reportFrameRates(); });
+      report->start(5000);
+    }
 
     m_hoverLabel = new QLabel(this);
     m_hoverLabel->setStyleSheet("color:#FFFFFF;background:rgba(0,0,0,80);"
@@ -180,9 +213,19 @@ public:
 
     setupMacroControls();
     loadPaletteConfig();
-#ifdef SC_ENABLE_TROCR
+    loadInputFilterConfig();
+    if (!m_options.recordPath.isEmpty()) {
+      if (m_recorder.open(m_options.recordPath.toStdString()))
+        SC_LOG(sc::LogLevel::Info,
+               "Recording input to " + m_options.recordPath.toStdString());
+      else
+        SC_LOG(sc::LogLevel::Error, "Failed to open input log " +
+                                        m_options.recordPath.toStdString());
+    }
+#ifdef SC_TROCR_BACKEND
     initializeTrocrDecoder();
 #endif
+    startRecognitionWarmup();
     loadMacroBindingsFromConfig();
     setupSettingsMenu();
     updateMacroPanelGeometry();
@@ -197,6 +240,15 @@ public:
     updateTabWidgetGeometry();
   }
 
+  ~CanvasWindow() override {
+    QCoreApplication::instance()->removeEventFilter(this);
+    // Skip queued decodes and let the running one finish before members go.
+    if (m_pendingSubmit)
+      m_pendingSubmit->cancelled->store(true);
+    m_decodePool.clear();
+    m_decodePool.waitForDone();
+  }
+
   void setHideOnClose(bool hide) { m_hideOnClose = hide; }
 
   const sc::PluginManager &pluginManager() const { return m_pluginManager; }
@@ -213,6 +265,23 @@ public:
     float life{1.f};
   };
 
+  // A mouse move waiting for the next frame (coalesceMoves).
+  struct PendingMove {
+    QPointF pos;
+    uint64_t timestamp;
+  };
+
+  // Moves processed per frame while coalescing, for the current gesture.
+  struct MoveCoalescingStats {
+    uint64_t frames{0};
+    uint64_t events{0};
+    uint64_t maxPerFrame{0};
+
+    double average() const {
+      return frames == 0 ? 0.0 : static_cast<double>(events) / frames;
+    }
+  };
+
   enum EdgeFlag {
     EdgeNone = 0x0,
     EdgeLeft = 0x1,
@@ -270,9 +339,13 @@ protected:
       }
     }
 
+    // Queued moves happened before this press.
+    processPendingMoves();
     const uint64_t ts =
         static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch());
     resetIdleTimer();
+    selectInputProfile(event);
+    recordEvent(sc::InputRecord::Type::Tap, event);
     bool wasCapturing = m_input.capturing();
     sc::TapAction act = m_input.onTapSequence(ts);
     bool nowCapturing = m_input.capturing();
@@ -281,12 +354,12 @@ protected:
       appendCursorTrace(event->pos());
     }
     if (act == sc::TapAction::StartSequence) {
+      m_moveStats = MoveCoalescingStats();
       m_pressPending = false;
       m_dragging = false;
       finishActiveStrokes();
-      auto &stroke = startStroke();
-      stroke.addPoint(event->pos());
-      m_input.addPoint(event->pos().x(), event->pos().y());
+      startStroke();
+      capturePoint(event);
       m_label->hide();
       SC_LOG(sc::LogLevel::Info, "Sequence start");
       updatePrediction();
@@ -305,19 +378,11 @@ protected:
     } else if (act == sc::TapAction::RecordStream) {
       SC_LOG(sc::LogLevel::Info, "Record stream" );
     } else if (nowCapturing) {
-      if (m_strokes.empty())
-        startStroke();
-      if (!m_strokes.back().isActive) {
-        finishActiveStrokes();
-        m_strokes.back().isActive = true;
-      }
-      m_strokes.back().opacity = 1.f;
-      m_strokes.back().addPoint(event->pos());
-      m_input.addPoint(event->pos().x(), event->pos().y());
+      if (capturePoint(event))
+        updatePrediction();
       m_label->hide();
-      updatePrediction();
     }
-    update();
+    scheduleRepaint();
   }
   void mouseMoveEvent(QMouseEvent *event) override {
     if (m_resizing) {
@@ -374,30 +439,26 @@ protected:
       else
         setCursor(Qt::BlankCursor);
     }
+    if (m_input.capturing())
+      recordEvent(sc::InputRecord::Type::Move, event);
+    if (m_options.coalesceMoves) {
+      m_pendingMoves.push_back(
+          {event->pos(), static_cast<uint64_t>(event->timestamp())});
+      wakeFrameTimer();
+      return;
+    }
     if (m_options.cursorAnimation) {
       m_ripples.push_back({event->pos(), 0.f, 1.f});
       appendCursorTrace(event->pos());
     }
     if (m_input.capturing()) {
-      if (m_strokes.empty())
-        startStroke();
-      if (!m_strokes.back().isActive) {
-        finishActiveStrokes();
-        m_strokes.back().isActive = true;
-      }
-      m_strokes.back().opacity = 1.f;
-      m_strokes.back().addPoint(event->pos());
-      m_input.addPoint(event->pos().x(), event->pos().y());
-      if (static_cast<int>(sc::globalLogLevel()) <=
-          static_cast<int>(sc::LogLevel::Debug)) {
-        SC_LOG(sc::LogLevel::Debug,
-               "Point " + std::to_string(event->pos().x()) + "," +
-                   std::to_string(event->pos().y()));
+      if (capturePoint(event)) {
+        logKeptPoint();
+        updatePrediction();
       }
       m_label->hide();
-      updatePrediction();
     }
-    update();
+    scheduleRepaint();
   }
   void mouseReleaseEvent(QMouseEvent *event) override {
     if (isTabRegion(event->pos()) || isMacroRegion(event->pos()) ||
@@ -420,11 +481,25 @@ protected:
   void resizeEvent(QResizeEvent *event) override {
     QWidget::resizeEvent(event);
     m_label->setGeometry(rect());
+    recacheLayers(false); // strokes clipped to the old size may now show
     updateMacroPanelGeometry();
     updateSettingsButtonGeometry();
     updateTabWidgetGeometry();
   }
-  void paintEvent(QPaintEvent *) override {
+  // Only the exposed region is repainted (see scheduleRepaint()); items
+  // outside it are skipped rather than drawn into the clip. The region is
+  // tested rect by rect, not by its bounding rect, so an item between two
+  // dirty areas is skipped too.
+  void paintEvent(QPaintEvent *event) override {
+    const QRegion &exposed = event->region();
+    // Layers rendered for another screen scale would be blurry or sized
+    // wrongly on this one.
+    const qreal dpr = devicePixelRatioF();
+    if (std::any_of(m_strokeLayers.begin(), m_strokeLayers.end(),
+                    [dpr](const StrokeLayer &layer) {
+                      return layer.image.devicePixelRatio() != dpr;
+                    }))
+      recacheLayers(true);
     QPainter p(this);
     p.setRenderHint(QPainter::Antialiasing);
     QRectF r = rect().adjusted(m_borderWidth / 2.0, m_borderWidth / 2.0,
@@ -438,6 +513,8 @@ protected:
     p.setClipPath(path);
     // ripples
     for (auto &r : m_ripples) {
+      if (!exposed.intersects(rippleRect(r)))
+        continue;
       QColor c = m_options.rippleColor;
       c.setAlphaF(c.alphaF() * r.opacity);
       p.setPen(Qt::NoPen);
@@ -445,7 +522,8 @@ protected:
       p.drawEllipse(r.pos, r.radius, r.radius);
     }
     // cursor trace
-    if (m_options.cursorAnimation && m_cursorTrace.size() >= 1) {
+    if (m_options.cursorAnimation && m_cursorTrace.size() >= 1 &&
+        exposed.intersects(traceRect())) {
       p.save();
       for (size_t i = 1; i < m_cursorTrace.size(); ++i) {
         float life = (m_cursorTrace[i - 1].life + m_cursorTrace[i].life) / 2.f;
@@ -469,22 +547,31 @@ protected:
       }
       p.restore();
     }
-    // strokes
+    // finished strokes, one blit per layer
+    for (const auto &layer : m_strokeLayers) {
+      const Stroke *first = findStroke(layer.strokeIds.front());
+      if (!first || first->opacity <= 0.f ||
+          !exposed.intersects(layer.rect.toAlignedRect()))
+        continue;
+      p.setOpacity(first->opacity);
+      p.drawImage(layer.rect.topLeft(), layer.image);
+    }
+    p.setOpacity(1.0);
+    // active and uncached strokes
     for (const auto &s : m_strokes) {
-      if (s.points.empty())
+      if (s.pointCount == 0 || (s.cached && !s.isActive) ||
+          !exposed.intersects(
+              s.bounds(m_options.strokeWidth).toAlignedRect()))
         continue;
       QColor col = m_options.strokeColor;
       float strokeOpacity = s.isActive ? 1.f : s.opacity;
       col.setAlphaF(col.alphaF() * strokeOpacity);
       QPen pen(col, m_options.strokeWidth);
       p.setPen(pen);
-      if (s.path.isEmpty()) {
-        p.drawEllipse(s.points.front(), 2, 2);
-      } else {
-        p.drawPath(s.path);
-      }
+      s.paint(p);
     }
-    if (!m_detectionRect.isNull()) {
+    if (!m_detectionRect.isNull() &&
+        exposed.intersects(detectionRect())) {
       QPen boxPen(m_options.detectionColor, 1, Qt::DashLine);
       boxPen.setCapStyle(Qt::RoundCap);
       boxPen.setJoinStyle(Qt::RoundJoin);
@@ -492,7 +579,8 @@ protected:
       p.setBrush(Qt::NoBrush);
       p.drawRect(m_detectionRect);
     }
-    if (!m_predictionPath.isEmpty() && m_predictionOpacity > 0.f) {
+    if (!m_predictionPath.isEmpty() && m_predictionOpacity > 0.f &&
+        exposed.intersects(predictionRect())) {
       QColor predColor(255, 255, 255);
       predColor.setAlphaF(m_predictionOpacity);
       QPen dashPen(predColor, 1, Qt::DashLine);
@@ -502,38 +590,107 @@ protected:
   }
 
 private slots:
+  // Recognition of the gesture itself is cheap and stays on the GUI thread,
+  // but the TrOCR forward pass is not: glyph rendering and decode run on
+  // m_decodePool and the submit is completed by finishSubmit() when the
+  // result is posted back. A newer submit completes any pending one straight
+  // away without a glyph and cancels its decode.
   void onSubmit() {
     if (m_input.points().empty())
       return;
-    std::string recognizedSymbol;
-    std::string executedCommand;
-    QString emittedGlyph;
-    QString trocrGlyph;
+    supersedePendingSubmit();
+    if (m_input.filterSettings().enabled()) {
+      const sc::InputFilterStats stats = m_input.gestureStats();
+      SC_LOG(sc::LogLevel::Debug,
+             "Input filter kept " + std::to_string(stats.kept) + " of " +
+                 std::to_string(stats.raw) + " points (" +
+                 std::to_string(static_cast<int>(stats.reductionRatio() * 100.0)) +
+                 "% fewer)");
+    }
+    if (m_options.coalesceMoves && m_moveStats.frames > 0) {
+      SC_LOG(sc::LogLevel::Debug,
+             "Coalesced " + std::to_string(m_moveStats.events) +
+                 " moves over " + std::to_string(m_moveStats.frames) +
+                 " frames (avg " +
+                 std::to_string(m_moveStats.average()) + ", max " +
+                 std::to_string(m_moveStats.maxPerFrame) + " per frame)");
+    }
+
+    // One snapshot of the gesture serves both the decode task and the
+    // pending submit; the rasterizer reads its stroke ranges in place.
+    auto points = std::make_shared<const sc::PointBuffer>(m_input.buffer());
+    if (m_warmup.ready()) {
+      submitGesture(std::move(points));
+    } else {
+      // The first gesture can arrive before the background warm-up is done.
+      // Recognize it once warm-up reports ready rather than blocking the GUI
+      // thread or racing warm-up for the same models.
+      m_deferredSubmits.push_back(std::move(points));
+    }
+    resetRecognitionState();
+    m_idleTimer->start();
+    scheduleRepaint();
+  }
 
-#ifdef SC_ENABLE_TROCR
+private:
+  void submitGesture(std::shared_ptr<const sc::PointBuffer> points) {
+#ifdef SC_TROCR_BACKEND
     if (m_trocrDecoder && m_trocrDecoder->available()) {
-      QImage glyphImage = renderGlyphForTrocr();
-      if (!glyphImage.isNull()) {
-        std::u32string decoded = m_trocrDecoder->decode(glyphImage);
-        for (char32_t cp : decoded) {
-          if (cp == U'\0')
-            continue;
-          QChar qc = QChar::fromUcs4(cp);
-          if (!qc.isNull() && qc.isSpace() && decoded.size() > 1)
-            continue;
-          trocrGlyph = mapCodepointToPalette(cp);
-          if (!trocrGlyph.isEmpty())
-            break;
-        }
-        if (trocrGlyph.isEmpty() && !decoded.empty())
-          trocrGlyph = mapCodepointToPalette(decoded.front());
-      }
+      const quint64 generation = ++m_submitGeneration;
+      auto cancelled = std::make_shared<std::atomic<bool>>(false);
+      m_pendingSubmit = PendingSubmit{generation, points, cancelled};
+      std::shared_ptr<sc::TrocrDecoder> decoder = m_trocrDecoder;
+      sc::GlyphRasterOptions raster;
+      raster.size = std::max(32, m_trocrInputSize);
+      raster.strokeWidth =
+          static_cast<float>(std::max(1.5, m_options.strokeWidth * 0.8));
+      m_decodePool.start([this, decoder, points, raster, generation, cancelled] {
+        if (cancelled->load())
+          return;
+        // The captured points go straight into a model-sized coverage
+        // buffer; each pool thread keeps its own.
+        thread_local sc::GlyphRasterizer rasterizer;
+        rasterizer.rasterize(*points, raster);
+        if (cancelled->load())
+          return;
+        std::u32string decoded =
+            decoder->decodeCoverage(rasterizer.data(), rasterizer.size(),
+                                    rasterizer.size(), cancelled.get());
+        if (cancelled->load())
+          return;
+        QMetaObject::invokeMethod(
+            this,
+            [this, generation, decoded = std::move(decoded)] {
+              onTrocrDecoded(generation, decoded);
+            },
+            Qt::QueuedConnection);
+      });
+      return;
     }
 #endif
 
-    std::string cmd = m_recognizer.commandForGesture(m_input.points());
+    finishSubmit(points->view(), QString());
+  }
+
+  // Runs on the GUI thread once warm-up is ready. Like newer submits, each
+  // deferred gesture completes the one before it.
+  void flushDeferredSubmits() {
+    std::vector<std::shared_ptr<const sc::PointBuffer>> deferred;
+    deferred.swap(m_deferredSubmits);
+    for (auto &points : deferred) {
+      supersedePendingSubmit();
+      submitGesture(std::move(points));
+    }
+  }
+
+  void finishSubmit(sc::PointView points, const QString &trocrGlyph) {
+    std::string recognizedSymbol;
+    std::string executedCommand;
+    QString emittedGlyph;
+
+    std::string cmd = m_recognizer.commandForGesture(points);
     if (cmd.empty()) {
-      std::string sym = m_router.recognize(m_input.points());
+      std::string sym = m_router.recognize(points);
       if (!sym.empty()) {
         recognizedSymbol = sym;
         std::string macroCmd;
@@ -554,7 +711,7 @@ private slots:
       }
     } else {
       executedCommand = cmd;
-      auto prediction = m_recognizer.predictWithDistance(m_input.points());
+      auto prediction = m_recognizer.predictWithDistance(points);
       if (!prediction.first.empty())
         recognizedSymbol = prediction.first;
       if (!trocrGlyph.isEmpty())
@@ -595,11 +752,43 @@ private slots:
       if (!m_equationState.tokens.isEmpty())
         clearEquationState(false);
     }
+  }
 
-    resetRecognitionState();
-    m_idleTimer->start();
-    update();
+  void supersedePendingSubmit() {
+    if (!m_pendingSubmit)
+      return;
+    PendingSubmit pending = std::move(*m_pendingSubmit);
+    m_pendingSubmit.reset();
+    pending.cancelled->store(true);
+    finishSubmit(pending.points->view(), QString());
+  }
+
+#ifdef SC_TROCR_BACKEND
+  void onTrocrDecoded(quint64 generation, const std::u32string &decoded) {
+    if (!m_pendingSubmit || m_pendingSubmit->generation != generation)
+      return;
+    PendingSubmit pending = std::move(*m_pendingSubmit);
+    m_pendingSubmit.reset();
+
+    QString trocrGlyph;
+    for (char32_t cp : decoded) {
+      if (cp == U'\0')
+        continue;
+      QChar qc = QChar::fromUcs4(cp);
+      if (!qc.isNull() && qc.isSpace() && decoded.size() > 1)
+        continue;
+      trocrGlyph = mapCodepointToPalette(cp);
+      if (!trocrGlyph.isEmpty())
+        break;
+    }
+    if (trocrGlyph.isEmpty() && !decoded.empty())
+      trocrGlyph = mapCodepointToPalette(decoded.front());
+    finishSubmit(pending.points->view(), trocrGlyph);
+    scheduleRepaint();
   }
+#endif
+
+private slots:
   void onTrainGesture() {
     if (m_input.points().empty())
       return;
@@ -637,13 +826,20 @@ private slots:
     m_recognizer.saveProfile("data/user_gestures.json");
     finishActiveStrokes();
     resetRecognitionState();
-    update();
+    scheduleRepaint();
   }
   void onFrame() {
+    ++m_framesInWindow;
+    // Animation steps are tuned for a 10 ms tick; a 60 Hz display advances
+    // them by 1.67 steps per frame so fades keep their duration. Long stalls
+    // are capped so a stroke does not vanish in a single frame.
+    const float step =
+        std::min(10.f, static_cast<float>(m_frameClock.restart()) / 10.f);
+    processPendingMoves();
     if (m_options.cursorAnimation) {
       for (auto &r : m_ripples) {
-        r.radius += m_options.rippleGrowthRate;
-        r.opacity -= 0.05f;
+        r.radius += m_options.rippleGrowthRate * step;
+        r.opacity -= 0.05f * step;
       }
       m_ripples.erase(
           std::remove_if(m_ripples.begin(), m_ripples.end(),
@@ -653,24 +849,33 @@ private slots:
                          }),
           m_ripples.end());
       for (auto &tp : m_cursorTrace)
-        tp.life -= 0.07f;
+        tp.life -= 0.07f * step;
       while (!m_cursorTrace.empty() && m_cursorTrace.front().life <= 0.f)
         m_cursorTrace.pop_front();
     }
     for (auto &s : m_strokes) {
       if (!s.isActive)
-        s.opacity = std::max(0.f, s.opacity - m_options.fadeRate);
+        s.opacity = std::max(0.f, s.opacity - m_options.fadeRate * step);
     }
     m_strokes.erase(std::remove_if(m_strokes.begin(), m_strokes.end(),
                                    [&](const Stroke &s) {
                                      return !s.isActive && s.opacity <= 0.f;
                                    }),
                     m_strokes.end());
+    // A layer's strokes fade together, so they are removed together.
+    m_strokeLayers.erase(
+        std::remove_if(m_strokeLayers.begin(), m_strokeLayers.end(),
+                       [&](const StrokeLayer &layer) {
+                         return !findStroke(layer.strokeIds.front());
+                       }),
+        m_strokeLayers.end());
     if (m_predictionOpacity > 0.f)
-      m_predictionOpacity -= 0.05f;
+      m_predictionOpacity -= 0.05f * step;
     if (m_predictionOpacity < 0.f)
       m_predictionOpacity = 0.f;
-    update();
+    scheduleRepaint();
+    if (m_pendingMoves.empty() && !animating())
+      m_timer->stop();
   }
 
 private:
@@ -694,15 +899,150 @@ private:
 
   Stroke &startStroke() {
     auto &stroke = m_strokes.emplace_back();
+    stroke.id = m_input.beginStroke();
     stroke.isActive = true;
     stroke.opacity = 1.f;
     return stroke;
   }
 
+  // Makes the last stroke active again, or starts a new one if its points
+  // are no longer in the input buffer.
+  void continueStroke() {
+    if (m_strokes.empty() || m_strokes.back().id != m_input.strokeId() ||
+        (m_strokes.back().pointCount > 0 &&
+         m_input.buffer().stroke(m_strokes.back().id).empty())) {
+      finishActiveStrokes();
+      startStroke();
+      return;
+    }
+    if (!m_strokes.back().isActive) {
+      finishActiveStrokes();
+      uncacheStroke(m_strokes.back().id);
+      m_strokes.back().isActive = true;
+    }
+    m_strokes.back().opacity = 1.f;
+  }
+
   void finishActiveStrokes() {
+    std::vector<uint32_t> finished;
     for (auto &stroke : m_strokes) {
-      if (stroke.isActive)
-        stroke.isActive = false;
+      if (!stroke.isActive)
+        continue;
+      stroke.finalize(m_input.buffer().stroke(stroke.id));
+      stroke.isActive = false;
+      if (stroke.pointCount > 0)
+        finished.push_back(stroke.id);
+    }
+    if (!finished.empty())
+      cacheStrokes(finished);
+  }
+
+  Stroke *findStroke(uint32_t id) {
+    for (auto &stroke : m_strokes) {
+      if (stroke.id == id)
+        return &stroke;
+    }
+    return nullptr;
+  }
+
+  const Stroke *findStroke(uint32_t id) const {
+    for (const auto &stroke : m_strokes) {
+      if (stroke.id == id)
+        return &stroke;
+    }
+    return nullptr;
+  }
+
+  // Renders strokes finished together into layer images covering their
+  // bounds, so paintEvent() blits each layer at its strokes' opacity instead
+  // of re-rasterizing their antialiased paths every frame. Only strokes of
+  // equal opacity share a layer; they fade at the same rate from then on.
+  // Ids that no longer name a stroke are skipped.
+  void cacheStrokes(const std::vector<uint32_t> &ids) {
+    std::vector<Stroke *> pending;
+    for (uint32_t id : ids) {
+      Stroke *stroke = findStroke(id);
+      if (!stroke || stroke->pointCount == 0)
+        continue;
+      // Stays vector-drawn if its layer cannot be rendered.
+      stroke->cached = false;
+      pending.push_back(stroke);
+    }
+    while (!pending.empty()) {
+      const float opacity = pending.front()->opacity;
+      auto split = std::stable_partition(
+          pending.begin(), pending.end(),
+          [opacity](const Stroke *s) { return s->opacity == opacity; });
+      cacheLayer(std::vector<Stroke *>(pending.begin(), split));
+      pending.erase(pending.begin(), split);
+    }
+  }
+
+  // The image covers only the part of the strokes inside the window; a
+  // clipped layer is rendered again by recacheLayers() when the window grows.
+  void cacheLayer(const std::vector<Stroke *> &strokes) {
+    QRectF bounds;
+    for (const Stroke *stroke : strokes)
+      bounds = bounds.united(stroke->bounds(m_options.strokeWidth));
+    const QRect full = bounds.toAlignedRect();
+    const QRect area = full.intersected(rect());
+    if (area.isEmpty())
+      return;
+    const qreal dpr = devicePixelRatioF();
+    QImage image(area.size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull())
+      return; // too large to cache; the strokes stay vector-drawn
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(-area.topLeft());
+    painter.setPen(QPen(m_options.strokeColor, m_options.strokeWidth));
+    std::vector<uint32_t> ids;
+    ids.reserve(strokes.size());
+    for (Stroke *stroke : strokes) {
+      stroke->paint(painter);
+      stroke->cached = true;
+      ids.push_back(stroke->id);
+    }
+    painter.end();
+    m_strokeLayers.push_back(
+        {std::move(ids), std::move(image), QRectF(area), area != full});
+  }
+
+  // Renders layers again from their strokes: every layer when `all` is set
+  // (e.g. the screen scale changed), otherwise only the clipped ones.
+  void recacheLayers(bool all) {
+    std::vector<uint32_t> ids;
+    m_strokeLayers.erase(
+        std::remove_if(m_strokeLayers.begin(), m_strokeLayers.end(),
+                       [&](const StrokeLayer &layer) {
+                         if (!all && !layer.clipped)
+                           return false;
+                         ids.insert(ids.end(), layer.strokeIds.begin(),
+                                    layer.strokeIds.end());
+                         return true;
+                       }),
+        m_strokeLayers.end());
+    if (!ids.empty())
+      cacheStrokes(ids);
+  }
+
+  // Takes a stroke out of its layer before it is drawn on again; the rest of
+  // the layer is rendered anew.
+  void uncacheStroke(uint32_t id) {
+    for (auto it = m_strokeLayers.begin(); it != m_strokeLayers.end(); ++it) {
+      auto pos = std::find(it->strokeIds.begin(), it->strokeIds.end(), id);
+      if (pos == it->strokeIds.end())
+        continue;
+      std::vector<uint32_t> rest = std::move(it->strokeIds);
+      rest.erase(std::remove(rest.begin(), rest.end(), id), rest.end());
+      m_strokeLayers.erase(it);
+      if (Stroke *stroke = findStroke(id))
+        stroke->cached = false;
+      if (!rest.empty())
+        cacheStrokes(rest);
+      return;
     }
   }
 
@@ -728,12 +1068,14 @@ private:
   }
 
   void updatePrediction() {
-    if (!m_showPrediction || m_input.points().empty()) {
+    if (!m_showPrediction || m_input.points().empty() || !m_warmup.ready()) {
       m_predictionPath = QPainterPath();
       m_detectionRect = QRectF();
       return;
     }
-    std::string sym = m_router.recognize(m_input.points());
+    const sc::ShapeDescriptors desc =
+        sc::describeShape(m_input.points(), m_shapeScratch);
+    std::string sym = m_router.recognize(m_input.points(), desc);
     if (sym.empty()) {
       m_predictionPath = QPainterPath();
       return;
@@ -751,17 +1093,7 @@ private:
     } else {
       showHoverFeedback(QString::fromStdString(sym));
     }
-    float minX = m_input.points()[0].x;
-    float minY = m_input.points()[0].y;
-    float maxX = minX;
-    float maxY = minY;
-    for (const auto &pt : m_input.points()) {
-      minX = std::min(minX, pt.x);
-      minY = std::min(minY, pt.y);
-      maxX = std::max(maxX, pt.x);
-      maxY = std::max(maxY, pt.y);
-    }
-    QRectF box(QPointF(minX, minY), QPointF(maxX, maxY));
+    QRectF box(QPointF(desc.minX, desc.minY), QPointF(desc.maxX, desc.maxY));
     m_detectionRect = box;
     box.adjust(-10, -10, 10, 10);
     QPainterPath pred;
@@ -1285,6 +1617,247 @@ private:
     return MacroBinding();
   }
 
+  // Per-device smoothing and decimation from config/input.json. Without the
+  // file every raw point is kept.
+  void loadInputFilterConfig() {
+    const QJsonObject cfg = readJsonObject(QStringLiteral("config/input.json"));
+    for (auto it = cfg.begin(); it != cfg.end(); ++it) {
+      const QJsonObject obj = it.value().toObject();
+      sc::InputFilterSettings settings;
+      settings.smoothing = obj.value(QStringLiteral("smoothing")).toBool(false);
+      settings.minCutoff = obj.value(QStringLiteral("min_cutoff")).toDouble(settings.minCutoff);
+      settings.beta = obj.value(QStringLiteral("beta")).toDouble(settings.beta);
+      settings.derivativeCutoff =
+          obj.value(QStringLiteral("derivative_cutoff")).toDouble(settings.derivativeCutoff);
+      settings.minSpacing = static_cast<float>(
+          obj.value(QStringLiteral("min_spacing")).toDouble(settings.minSpacing));
+      settings.maxSpacing = static_cast<float>(
+          obj.value(QStringLiteral("max_spacing")).toDouble(settings.maxSpacing));
+      settings.turnDegrees = static_cast<float>(
+          obj.value(QStringLiteral("turn_degrees")).toDouble(settings.turnDegrees));
+      settings.maxPoints = static_cast<size_t>(
+          std::max(0, obj.value(QStringLiteral("max_points")).toInt(0)));
+      m_inputProfiles[it.key()] = settings;
+    }
+  }
+
+  // Switches the input filter to the profile of the device that sent
+  // `event`. Qt reports touch input as synthesized mouse events.
+  void selectInputProfile(const QMouseEvent *event) {
+    if (m_input.capturing())
+      return;
+    const QString device = event->source() == Qt::MouseEventNotSynthesized
+                               ? QStringLiteral("mouse")
+                               : QStringLiteral("touch");
+    if (device == m_inputDevice)
+      return;
+    m_inputDevice = device;
+    auto it = m_inputProfiles.find(device);
+    m_input.setFilterSettings(it != m_inputProfiles.end() ? it->second
+                                                          : sc::InputFilterSettings());
+  }
+
+  // Appends the event to the input log when recording (--record).
+  void recordEvent(sc::InputRecord::Type type, const QMouseEvent *event) {
+    if (!m_recorder.isOpen())
+      return;
+    const sc::InputDevice device = event->source() == Qt::MouseEventNotSynthesized
+                                       ? sc::InputDevice::Mouse
+                                       : sc::InputDevice::Touch;
+    m_recorder.record(type, device, static_cast<float>(event->pos().x()),
+                      static_cast<float>(event->pos().y()));
+  }
+
+  // Feeds one event position through the input filter into the active
+  // stroke. Returns false for points the filter drops.
+  bool capturePoint(const QMouseEvent *event) {
+    if (!ingestPoint(event->pos(), static_cast<uint64_t>(event->timestamp())))
+      return false;
+    m_strokes.back().appendPoints(m_input.buffer().stroke(m_strokes.back().id));
+    return true;
+  }
+
+  // capturePoint() without the path update, for callers that add several
+  // points before drawing.
+  bool ingestPoint(const QPointF &pos, uint64_t timestamp) {
+    continueStroke();
+    return m_input.addPoint(static_cast<float>(pos.x()),
+                            static_cast<float>(pos.y()), timestamp);
+  }
+
+  // Runs the moves queued since the last frame through the pipeline once:
+  // every position reaches the cursor trace and the input filter, but the
+  // stroke path, the prediction and the ripple are updated for the batch.
+  void processPendingMoves() {
+    if (m_pendingMoves.empty())
+      return;
+    const uint64_t count = m_pendingMoves.size();
+    if (m_options.cursorAnimation) {
+      m_ripples.push_back({m_pendingMoves.back().pos, 0.f, 1.f});
+      for (const PendingMove &move : m_pendingMoves)
+        appendCursorTrace(move.pos);
+    }
+    if (m_input.capturing()) {
+      bool kept = false;
+      for (const PendingMove &move : m_pendingMoves)
+        kept |= ingestPoint(move.pos, move.timestamp);
+      if (kept) {
+        m_strokes.back().appendPoints(
+            m_input.buffer().stroke(m_strokes.back().id));
+        logKeptPoint();
+        updatePrediction();
+      }
+      m_label->hide();
+      ++m_moveStats.frames;
+      m_moveStats.events += count;
+      m_moveStats.maxPerFrame = std::max(m_moveStats.maxPerFrame, count);
+    }
+    m_pendingMoves.clear();
+    scheduleRepaint();
+  }
+
+  // Repaints only what changed since the last call: animated items
+  // (ripples, cursor trace, fading strokes and prediction) where they were
+  // and where they are now, new segments of the active strokes, and the
+  // detection rect when it moved.
+  void scheduleRepaint() {
+    QRegion animated;
+    for (const auto &r : m_ripples)
+      animated += rippleRect(r);
+    if (m_options.cursorAnimation && !m_cursorTrace.empty())
+      animated += traceRect();
+    // Finished strokes only change while they fade; with a fade rate of 0
+    // they keep their pixels until new segments mark them dirty.
+    if (m_options.fadeRate > 0.f) {
+      for (const auto &layer : m_strokeLayers)
+        animated += layer.rect.toAlignedRect();
+      for (const auto &s : m_strokes) {
+        if (!s.isActive && !s.cached && s.pointCount > 0)
+          animated += s.bounds(m_options.strokeWidth).toAlignedRect();
+      }
+    }
+    if (!m_predictionPath.isEmpty() && m_predictionOpacity > 0.f)
+      animated += predictionRect();
+
+    QRegion dirty = animated + m_animatedRegion;
+    m_animatedRegion = animated;
+    for (auto &s : m_strokes) {
+      const QRectF head = s.takeDirtyRect(m_options.strokeWidth);
+      if (!head.isEmpty())
+        dirty += head.toAlignedRect();
+    }
+    const QRect detection =
+        m_detectionRect.isNull() ? QRect() : detectionRect();
+    if (detection != m_paintedDetection) {
+      dirty += detection;
+      dirty += m_paintedDetection;
+      m_paintedDetection = detection;
+    }
+    if (!dirty.isEmpty())
+      update(dirty);
+    if (animating())
+      wakeFrameTimer();
+  }
+
+  // True while something changes from frame to frame on its own.
+  bool animating() const {
+    if (!m_ripples.empty() || m_predictionOpacity > 0.f)
+      return true;
+    if (m_options.cursorAnimation && !m_cursorTrace.empty())
+      return true;
+    if (m_options.fadeRate <= 0.f)
+      return false; // finished strokes stay until cleared
+    for (const auto &s : m_strokes) {
+      if (!s.isActive)
+        return true; // fading; removed once fully transparent
+    }
+    return false;
+  }
+
+  // Starts ticking at the display's refresh rate; onFrame() stops the timer
+  // again once nothing animates and no moves are queued.
+  void wakeFrameTimer() {
+    if (m_timer->isActive())
+      return;
+    QScreen *screen = windowHandle() ? windowHandle()->screen()
+                                     : QGuiApplication::primaryScreen();
+    const qreal hz = screen ? screen->refreshRate() : 60.0;
+    m_timer->start(std::max(1, qRound(1000.0 / (hz > 1.0 ? hz : 60.0))));
+    m_frameClock.restart();
+  }
+
+  // Counts every timer event delivered to the GUI thread, including the
+  // report timer's own; the ones that arrive while the canvas has nothing to
+  // animate are idle wakeups. Only installed at DEBUG level.
+  bool eventFilter(QObject *watched, QEvent *event) override {
+    if (event->type() == QEvent::Timer) {
+      ++m_wakeupsInWindow;
+      if (m_pendingMoves.empty() && !animating())
+        ++m_idleWakeupsInWindow;
+    }
+    return QWidget::eventFilter(watched, event);
+  }
+
+  // Logs frame ticks and the wakeups counted by eventFilter() per second
+  // since the last report, idle or not.
+  void reportFrameRates() {
+    const double seconds = m_frameWindow.restart() / 1000.0;
+    if (seconds <= 0.0)
+      return;
+    SC_LOG(sc::LogLevel::Debug,
+           "Frames " + std::to_string(m_framesInWindow / seconds) +
+               "/s, timer wakeups " +
+               std::to_string(m_wakeupsInWindow / seconds) +
+               "/s, idle wakeups " +
+               std::to_string(m_idleWakeupsInWindow / seconds) + "/s");
+    m_framesInWindow = 0;
+    m_wakeupsInWindow = 0;
+    m_idleWakeupsInWindow = 0;
+  }
+
+  QRect rippleRect(const Ripple &r) const {
+    const qreal radius = r.radius + 1.0;
+    return QRectF(r.pos.x() - radius, r.pos.y() - radius, 2 * radius,
+                  2 * radius)
+        .toAlignedRect();
+  }
+
+  // Trace segments are at most strokeWidth / 2 + 1 wide; the head dot has
+  // radius 3.
+  QRect traceRect() const {
+    qreal left = m_cursorTrace.front().pos.x(), right = left;
+    qreal top = m_cursorTrace.front().pos.y(), bottom = top;
+    for (const auto &tp : m_cursorTrace) {
+      left = std::min(left, tp.pos.x());
+      right = std::max(right, tp.pos.x());
+      top = std::min(top, tp.pos.y());
+      bottom = std::max(bottom, tp.pos.y());
+    }
+    const qreal pad = m_options.strokeWidth / 2.0 + 5.0;
+    return QRectF(QPointF(left - pad, top - pad),
+                  QPointF(right + pad, bottom + pad))
+        .toAlignedRect();
+  }
+
+  QRect detectionRect() const {
+    return m_detectionRect.adjusted(-2, -2, 2, 2).toAlignedRect();
+  }
+
+  QRect predictionRect() const {
+    return m_predictionPath.controlPointRect()
+        .adjusted(-2, -2, 2, 2)
+        .toAlignedRect();
+  }
+
+  void logKeptPoint() const {
+    if (static_cast<int>(sc::globalLogLevel()) >
+        static_cast<int>(sc::LogLevel::Debug))
+      return;
+    const sc::Point kept = m_input.buffer().back();
+    SC_LOG(sc::LogLevel::Debug,
+           "Point " + std::to_string(kept.x) + "," + std::to_string(kept.y));
+  }
+
   QJsonObject readJsonObject(const QString &path) const {
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly))
@@ -1445,75 +2018,64 @@ private:
     return QString::fromUcs4(&codepoint, 1);
   }
 
-#ifdef SC_ENABLE_TROCR
+  void startRecognitionWarmup() {
+    int budget = qEnvironmentVariableIntValue("SC_WARMUP_BUDGET_MS");
+    if (budget > 0)
+      m_warmup.setBudgetMs(budget);
+    m_router.addWarmupTasks(m_warmup);
+    m_warmup.setOnReady([this] {
+      QMetaObject::invokeMethod(
+          this, [this] { flushDeferredSubmits(); }, Qt::QueuedConnection);
+    });
+#ifdef SC_TROCR_BACKEND
+    if (m_trocrDecoder && m_trocrDecoder->available()) {
+      sc::TrocrDecoder *decoder = m_trocrDecoder.get();
+      m_warmup.add("trocr", [decoder] { return decoder->warmUp(); });
+    }
+#endif
+    m_warmup.start();
+  }
+
+#ifdef SC_TROCR_BACKEND
   void initializeTrocrDecoder() {
     m_trocrInputSize = 384;
     QJsonObject cfg = readJsonObject(QStringLiteral("config/trocr.json"));
-    QString modulePath = cfg.value(QStringLiteral("module")).toString();
-    QString tokenizerPath = cfg.value(QStringLiteral("tokenizer")).toString();
+    // The ONNX backend reads its token table from the model directory, so
+    // it needs no tokenizer path.
+    const bool onnx =
+        cfg.value(QStringLiteral("backend")).toString() == QStringLiteral("onnx");
+    QString modulePath =
+        cfg.value(onnx ? QStringLiteral("onnx_model") : QStringLiteral("module")).toString();
+    QString tokenizerPath =
+        onnx ? QString() : cfg.value(QStringLiteral("tokenizer")).toString();
+    QString tokenTablePath =
+        onnx ? QString() : cfg.value(QStringLiteral("token_table")).toString();
     int configuredSize = cfg.value(QStringLiteral("input_size")).toInt();
     if (configuredSize > 0)
       m_trocrInputSize = configuredSize;
-    if (!modulePath.isEmpty() && !tokenizerPath.isEmpty()) {
-      m_trocrDecoder = std::make_unique<sc::TrocrDecoder>(
+    if (!modulePath.isEmpty() &&
+        (onnx || !tokenizerPath.isEmpty() || !tokenTablePath.isEmpty())) {
+      m_trocrDecoder = std::make_shared<sc::TrocrDecoder>(
           modulePath.toStdString(), tokenizerPath.toStdString(), m_trocrInputSize);
+      m_trocrDecoder->setBackend(onnx ? sc::TrocrDecoder::Backend::Onnx
+                                      : sc::TrocrDecoder::Backend::Torch);
+      m_trocrDecoder->setTokenTablePath(tokenTablePath.toStdString());
+      m_trocrDecoder->setReplicaCount(cfg.value(QStringLiteral("replicas")).toInt(1));
+      m_trocrDecoder->setIntraOpThreads(
+          cfg.value(QStringLiteral("intra_op_threads")).toInt(0));
+      m_trocrDecoder->setInterOpThreads(
+          cfg.value(QStringLiteral("inter_op_threads")).toInt(0));
+      m_trocrDecoder->setOptimizeOnLoad(
+          cfg.value(QStringLiteral("optimize_on_load")).toBool(false));
+      m_trocrDecoder->setMaxLength(cfg.value(QStringLiteral("max_length")).toInt(16));
+      m_trocrDecoder->setNumBeams(cfg.value(QStringLiteral("num_beams")).toInt(1));
+      m_decodePool.setMaxThreadCount(m_trocrDecoder->replicaCount());
     } else {
       m_trocrDecoder.reset();
     }
   }
-
-  QImage renderGlyphForTrocr() const {
-    if (!m_trocrDecoder || m_strokes.empty())
-      return QImage();
-    const int size = std::max(32, m_trocrInputSize);
-    QImage image(size, size, QImage::Format_RGBA8888);
-    image.fill(Qt::white);
-    QPainter painter(&image);
-    painter.setRenderHint(QPainter::Antialiasing, true);
-
-    QRectF bounds;
-    bool hasBounds = false;
-    for (const auto &stroke : m_strokes) {
-      if (stroke.path.isEmpty())
-        continue;
-      if (!hasBounds) {
-        bounds = stroke.path.boundingRect();
-        hasBounds = true;
-      } else {
-        bounds = bounds.united(stroke.path.boundingRect());
-      }
-    }
-    if (!hasBounds || bounds.width() <= 0.0 || bounds.height() <= 0.0)
-      return image;
-
-    const qreal marginRatio = 0.15;
-    QRectF targetRect(marginRatio * size, marginRatio * size,
-                      size * (1 - 2 * marginRatio),
-                      size * (1 - 2 * marginRatio));
-    QTransform transform;
-    qreal scale = std::min(targetRect.width() / bounds.width(),
-                           targetRect.height() / bounds.height());
-    transform.translate(targetRect.center().x(), targetRect.center().y());
-    transform.scale(scale, scale);
-    transform.translate(-bounds.center().x(), -bounds.center().y());
-    painter.setTransform(transform);
-
-    QPen pen(Qt::black, std::max(1.5, m_options.strokeWidth * 0.8));
-    pen.setCapStyle(Qt::RoundCap);
-    pen.setJoinStyle(Qt::RoundJoin);
-    painter.setPen(pen);
-    painter.setBrush(Qt::NoBrush);
-
-    for (const auto &stroke : m_strokes) {
-      if (!stroke.path.isEmpty())
-        painter.drawPath(stroke.path);
-    }
-    painter.end();
-    return image;
-  }
 #else
   void initializeTrocrDecoder() {}
-  QImage renderGlyphForTrocr() const { return QImage(); }
 #endif
 
   void restorePreviousSelection(const std::string &symbol, const QString &id) {
@@ -1689,58 +2251,37 @@ private:
   }
   
   sc::InputManager m_input;
+  std::map<QString, sc::InputFilterSettings> m_inputProfiles;
+  QString m_inputDevice;
+  sc::InputRecorder m_recorder;
   QLabel *m_label;
   QPushButton *m_closeBtn;
   QPushButton *m_minBtn;
   QPushButton *m_maxBtn;
-  struct Stroke {
-    std::vector<QPointF> points;
-    QPainterPath path;
-    float opacity{1.f};
-    bool isActive{false};
-
-    void addPoint(const QPointF &p) {
-      points.push_back(p);
-      rebuildPath();
-    }
-
-    void rebuildPath() {
-      path = buildPath(points);
-    }
-
-    static QPainterPath buildPath(const std::vector<QPointF> &pts) {
-      QPainterPath p;
-      if (pts.empty())
-        return p;
-
-      std::vector<QPointF> smoothed;
-      smoothed.reserve(pts.size());
-      for (size_t i = 0; i < pts.size(); ++i) {
-        if (i < 2) {
-          smoothed.push_back(pts[i]);
-        } else {
-          QPointF avg = (pts[i] + pts[i - 1] + pts[i - 2]) / 3.0;
-          smoothed.push_back(avg);
-        }
-      }
-
-      p.moveTo(smoothed[0]);
-      if (smoothed.size() == 1)
-        return p;
-
-      for (size_t i = 1; i < smoothed.size() - 1; ++i) {
-        QPointF mid = (smoothed[i] + smoothed[i + 1]) / 2.0;
-        p.quadTo(smoothed[i], mid);
-      }
-      p.lineTo(smoothed.back());
-      return p;
-    }
-  };
   std::vector<Stroke> m_strokes;
+  // Raster cache of finished strokes; see cacheStrokes().
+  struct StrokeLayer {
+    std::vector<uint32_t> strokeIds;
+    QImage image;
+    QRectF rect;
+    bool clipped{false}; // the strokes extend past the window
+  };
+  std::vector<StrokeLayer> m_strokeLayers;
+  // Animated overlay area painted last time, and the painted detection rect;
+  // see scheduleRepaint().
+  QRegion m_animatedRegion;
+  QRect m_paintedDetection;
   CanvasWindowOptions m_options;
   std::vector<Ripple> m_ripples;
   std::deque<TracePoint> m_cursorTrace;
+  std::vector<PendingMove> m_pendingMoves;
+  MoveCoalescingStats m_moveStats;
   QTimer *m_timer;
+  QElapsedTimer m_frameClock; // time since the previous frame tick
+  QElapsedTimer m_frameWindow; // since the last reportFrameRates()
+  int m_framesInWindow{0};
+  int m_wakeupsInWindow{0};
+  int m_idleWakeupsInWindow{0};
   QTimer *m_idleTimer;
   QShortcut *m_exitEsc;
   QShortcut *m_exitCtrlC;
@@ -1750,6 +2291,7 @@ private:
   QShortcut *m_redoShortcut;
   sc::GestureRecognizer m_recognizer;
   sc::RecognizerRouter m_router;
+  sc::ShapeScratch m_shapeScratch;
   QWidget *m_macroPanel{nullptr};
   QToolButton *m_settingsButton{nullptr};
   QMenu *m_settingsMenu{nullptr};
@@ -1778,10 +2320,24 @@ private:
   } m_equationState;
   std::unordered_map<std::string, MacroUIRow> m_macroRows;
   std::unordered_map<std::string, MacroBinding> m_macroBindings;
-#ifdef SC_ENABLE_TROCR
-  std::unique_ptr<sc::TrocrDecoder> m_trocrDecoder;
+#ifdef SC_TROCR_BACKEND
+  // Shared with in-flight decode tasks.
+  std::shared_ptr<sc::TrocrDecoder> m_trocrDecoder;
 #endif
   int m_trocrInputSize{384};
+  // Declared after the router and decoder so its thread is joined first.
+  sc::ModelWarmup m_warmup;
+  // A submit waiting for its TrOCR glyph.
+  struct PendingSubmit {
+    quint64 generation;
+    std::shared_ptr<const sc::PointBuffer> points;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+  };
+  std::optional<PendingSubmit> m_pendingSubmit;
+  // Gestures submitted before warm-up was ready, oldest first.
+  std::vector<std::shared_ptr<const sc::PointBuffer>> m_deferredSubmits;
+  quint64 m_submitGeneration{0};
+  QThreadPool m_decodePool;
   std::vector<QString> m_paletteEntries;
   std::unordered_map<uint32_t, QString> m_paletteDirect;
   std::unordered_map<uint32_t, QString> m_paletteOverrides;
@@ -0,0 +1,204 @@
+#pragma once
+#include "core/input/PointBuffer.hpp"
+#include <QPainter>
+#include <QPainterPath>
+#include <QPointF>
+#include <QRectF>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A drawn stroke. Its points live in the canvas InputManager's buffer under
+// `id`; the stroke keeps only what it needs to keep fading out after the
+// gesture's points are cleared.
+//
+// The path smooths each point with the two before it and joins the smoothed
+// points with quadratic segments through their midpoints. While the stroke
+// is being drawn, appendPoints() extends the path by the new segments only;
+// the straight tail to the newest point is kept apart (it is replaced by a
+// quad when the next point arrives) and drawn separately. finalize() rebuilds
+// the whole path once, from the points as finally stored.
+struct Stroke {
+  uint32_t id{0};
+  size_t pointCount{0};
+  QPointF start;
+  QPainterPath path;
+  float opacity{1.f};
+  bool isActive{false};
+  // Set while the canvas draws the stroke from a cached raster layer.
+  bool cached{false};
+
+  // Adds the points of `pts` (all points of the stroke so far) that the path
+  // does not cover yet. Falls back to a rebuild when the points before them
+  // changed, e.g. after the input manager thinned the gesture.
+  void appendPoints(sc::PointView pts) {
+    if (m_finalized || pts.size() < pointCount ||
+        (pointCount > 0 && (pts.x(pointCount - 1) != m_rawX[0] ||
+                            pts.y(pointCount - 1) != m_rawY[0])))
+      reset();
+    for (size_t i = pointCount; i < pts.size(); ++i)
+      push(pts.x(i), pts.y(i));
+  }
+
+  // Ends the stroke: the path becomes buildPath() of its final points, or of
+  // the points seen so far when `pts` no longer holds them.
+  void finalize(sc::PointView pts) {
+    if (!pts.empty() && pts.size() >= pointCount) {
+      rebuildPath(pts);
+    } else if (m_hasTail) {
+      path.lineTo(m_last);
+    }
+    m_hasTail = false;
+    m_finalized = true;
+  }
+
+  // Replaces the path with buildPath(pts).
+  void rebuildPath(sc::PointView pts) {
+    reset();
+    for (size_t i = 0; i < pts.size(); ++i)
+      push(pts.x(i), pts.y(i));
+    if (m_hasTail)
+      path.lineTo(m_last);
+    m_hasTail = false;
+  }
+
+  // Area paint() may touch with a pen `penWidth` wide.
+  QRectF bounds(qreal penWidth) const {
+    QRectF r;
+    bool any = false;
+    if (pointCount == 0)
+      return r;
+    extend(r, any, start);
+    if (!path.isEmpty()) {
+      const QRectF control = path.controlPointRect();
+      extend(r, any, control.topLeft());
+      extend(r, any, control.bottomRight());
+    }
+    if (m_hasTail)
+      extend(r, any, m_last);
+    return pad(r, penWidth);
+  }
+
+  // Area whose pixels changed since the last call (new segments, or the
+  // old and new path after a rebuild), padded for a pen `penWidth` wide.
+  // Empty when nothing changed.
+  QRectF takeDirtyRect(qreal penWidth) {
+    if (!m_hasDirty)
+      return QRectF();
+    m_hasDirty = false;
+    return pad(m_dirty, penWidth);
+  }
+
+  // Draws the path (or a dot for a single point) with the painter's pen.
+  void paint(QPainter &p) const {
+    if (pointCount == 0)
+      return;
+    if (path.isEmpty()) {
+      p.drawEllipse(start, 2, 2);
+      return;
+    }
+    p.drawPath(path);
+    if (m_hasTail)
+      p.drawLine(path.currentPosition(), m_last);
+  }
+
+  // The complete path in one pass over the points; the incremental path
+  // matches it segment for segment.
+  static QPainterPath buildPath(sc::PointView pts) {
+    QPainterPath p;
+    if (pts.empty())
+      return p;
+
+    std::vector<QPointF> smoothed;
+    smoothed.reserve(pts.size());
+    for (size_t i = 0; i < pts.size(); ++i) {
+      if (i < 2) {
+        smoothed.emplace_back(pts.x(i), pts.y(i));
+      } else {
+        smoothed.emplace_back((pts.x(i) + pts.x(i - 1) + pts.x(i - 2)) / 3.0,
+                              (pts.y(i) + pts.y(i - 1) + pts.y(i - 2)) / 3.0);
+      }
+    }
+
+    p.moveTo(smoothed[0]);
+    if (smoothed.size() == 1)
+      return p;
+
+    for (size_t i = 1; i < smoothed.size() - 1; ++i) {
+      QPointF mid = (smoothed[i] + smoothed[i + 1]) / 2.0;
+      p.quadTo(smoothed[i], mid);
+    }
+    p.lineTo(smoothed.back());
+    return p;
+  }
+
+private:
+  void reset() {
+    if (pointCount > 0) {
+      const QRectF old = bounds(0);
+      extend(m_dirty, m_hasDirty, old.topLeft());
+      extend(m_dirty, m_hasDirty, old.bottomRight());
+    }
+    path = QPainterPath();
+    pointCount = 0;
+    m_hasTail = false;
+    m_finalized = false;
+  }
+
+  // Same arithmetic as buildPath(), so both produce identical segments.
+  void push(float x, float y) {
+    const QPointF smoothed =
+        pointCount < 2 ? QPointF(x, y)
+                       : QPointF((x + m_rawX[0] + m_rawX[1]) / 3.0,
+                                 (y + m_rawY[0] + m_rawY[1]) / 3.0);
+    extend(m_dirty, m_hasDirty, smoothed);
+    if (pointCount == 0) {
+      start = QPointF(x, y);
+      extend(m_dirty, m_hasDirty, start);
+      path.moveTo(smoothed);
+    } else {
+      extend(m_dirty, m_hasDirty, path.currentPosition());
+      extend(m_dirty, m_hasDirty, m_last);
+      // The previous point stops being the tail: its quad ends halfway to
+      // the new point.
+      if (pointCount >= 2)
+        path.quadTo(m_last, (m_last + smoothed) / 2.0);
+      m_hasTail = true;
+    }
+    m_rawX[1] = m_rawX[0];
+    m_rawY[1] = m_rawY[0];
+    m_rawX[0] = x;
+    m_rawY[0] = y;
+    m_last = smoothed;
+    ++pointCount;
+  }
+
+  static void extend(QRectF &r, bool &any, const QPointF &p) {
+    if (!any) {
+      r = QRectF(p, p);
+      any = true;
+      return;
+    }
+    r.setLeft(std::min(r.left(), p.x()));
+    r.setRight(std::max(r.right(), p.x()));
+    r.setTop(std::min(r.top(), p.y()));
+    r.setBottom(std::max(r.bottom(), p.y()));
+  }
+
+  // Pen overhang plus a margin for antialiasing and the single-point dot.
+  static QRectF pad(const QRectF &r, qreal penWidth) {
+    const qreal m = penWidth / 2.0 + 3.0;
+    return r.adjusted(-m, -m, m, m);
+  }
+
+  // Smoothing window: the last two raw points (newest first) and the last
+  // smoothed one.
+  float m_rawX[2]{0.f, 0.f};
+  float m_rawY[2]{0.f, 0.f};
+  QPointF m_last;
+  bool m_hasTail{false};
+  bool m_finalized{false};
+  QRectF m_dirty;
+  bool m_hasDirty{false};
+};
@@ -96,13 +96,17 @@ int main(int argc, char** argv) {
     QCommandLineOption strokeColorOpt({"s", "stroke-color"},
         "Stroke color (hex)", "color", "#fffbe0");
     QCommandLineOption fadeRateOpt({"f", "fade-rate"},
-        "Stroke fade per frame", "rate", "0.005");
+        "Stroke fade per 10 ms (0 keeps strokes)", "rate", "0.005");
     QCommandLineOption detectionColorOpt({"d", "detection-color"},
         "Detection box color (hex)", "color", "#ffffff66");
     QCommandLineOption fullscreenOpt({"F", "fullscreen"},
         "Launch the board fullscreen");
     QCommandLineOption disableCursorAnimOpt({"A", "no-cursor-animation"},
         "Disable cursor animation (enabled by default)");
+    QCommandLineOption recordOpt({"R", "record"},
+        "Record raw input events to a binary log for symbolcast-replay", "file");
+    QCommandLineOption coalesceOpt({"C", "coalesce-moves"},
+        "Process mouse moves once per frame instead of per event");
 
     parser.addOption(rippleGrowthOpt);
     parser.addOption(rippleMaxOpt);
@@ -113,6 +117,8 @@ int main(int argc, char** argv) {
     parser.addOption(detectionColorOpt);
     parser.addOption(fullscreenOpt);
     parser.addOption(disableCursorAnimOpt);
+    parser.addOption(recordOpt);
+    parser.addOption(coalesceOpt);
 
     parser.process(app);
 
@@ -131,6 +137,8 @@ int main(int argc, char** argv) {
     opts.fullscreen = parser.isSet(fullscreenOpt);
     if (parser.isSet(disableCursorAnimOpt))
         opts.cursorAnimation = false;
+    opts.recordPath = parser.value(recordOpt);
+    opts.coalesceMoves = parser.isSet(coalesceOpt);
 
     SC_LOG(sc::LogLevel::Info, "SymbolCast Desktop starting");
     CanvasWindow win(opts);
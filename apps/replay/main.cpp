@@ -0,0 +1,171 @@
+#include "core/input/InputReplayer.hpp"
+#include "core/recognition/RecognizerRouter.hpp"
+#include "core/recognition/ShapeDescriptors.hpp"
+#include "utils/Logger.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Replays an input log written by `symbolcast-desktop --record` through the
+// capture and recognition pipeline and reports throughput and stage latency.
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: symbolcast-replay <log> [--realtime] [--speed <x>]\n"
+                 "         [--models <config/models.json>] [--input <config/input.json>]\n"
+                 "         [--smoothing] [--min-spacing <px>] [--max-spacing <px>]\n"
+                 "         [--max-points <n>]\n"
+                 "Feeds the log as fast as possible unless --realtime is given. Each\n"
+                 "device's gestures use its profile from --input, unless a filter\n"
+                 "option is given, which then applies to every device.\n";
+}
+
+// Reads `key` from a flat JSON object body; leaves `value` alone if absent.
+template <typename T>
+void readSetting(const std::string& body, const char* key, T& value) {
+    const size_t pos = body.find(std::string("\"") + key + "\"");
+    if (pos == std::string::npos)
+        return;
+    size_t colon = body.find(':', pos);
+    if (colon == std::string::npos)
+        return;
+    const char* text = body.c_str() + colon + 1;
+    while (*text == ' ' || *text == '\t' || *text == '\n' || *text == '\r')
+        ++text;
+    if (std::strncmp(text, "true", 4) == 0)
+        value = static_cast<T>(1);
+    else if (std::strncmp(text, "false", 5) == 0)
+        value = static_cast<T>(0);
+    else
+        value = static_cast<T>(std::strtod(text, nullptr));
+}
+
+// Loads the per-device filter profiles of config/input.json (the keys the
+// desktop app reads) into `replayer`. Returns false if the file is missing.
+bool loadDeviceProfiles(const std::string& path, sc::InputReplayer& replayer) {
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+    const std::string content((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+    const std::pair<const char*, sc::InputDevice> devices[] = {
+        {"mouse", sc::InputDevice::Mouse},
+        {"touch", sc::InputDevice::Touch},
+        {"pen", sc::InputDevice::Pen},
+        {"vr", sc::InputDevice::Vr}};
+    for (const auto& device : devices) {
+        const size_t key = content.find(std::string("\"") + device.first + "\"");
+        if (key == std::string::npos)
+            continue;
+        const size_t open = content.find('{', key);
+        const size_t close = content.find('}', open);
+        if (open == std::string::npos || close == std::string::npos)
+            continue;
+        const std::string body = content.substr(open + 1, close - open - 1);
+        sc::InputFilterSettings settings;
+        readSetting(body, "smoothing", settings.smoothing);
+        readSetting(body, "min_cutoff", settings.minCutoff);
+        readSetting(body, "beta", settings.beta);
+        readSetting(body, "derivative_cutoff", settings.derivativeCutoff);
+        readSetting(body, "min_spacing", settings.minSpacing);
+        readSetting(body, "max_spacing", settings.maxSpacing);
+        readSetting(body, "turn_degrees", settings.turnDegrees);
+        double maxPoints = 0.0;
+        readSetting(body, "max_points", maxPoints);
+        settings.maxPoints = maxPoints > 0.0 ? static_cast<size_t>(maxPoints) : 0;
+        replayer.setDeviceFilter(device.second, settings);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    const std::string logPath = argv[1];
+    sc::ReplayOptions options;
+    sc::InputFilterSettings filter;
+    bool filterOverride = false;
+    std::string models = "config/models.json";
+    std::string inputConfig = "config/input.json";
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--realtime") {
+            options.realtime = true;
+        } else if (arg == "--speed" && hasValue) {
+            options.speed = std::atof(argv[++i]);
+        } else if (arg == "--models" && hasValue) {
+            models = argv[++i];
+        } else if (arg == "--input" && hasValue) {
+            inputConfig = argv[++i];
+        } else if (arg == "--smoothing") {
+            filter.smoothing = true;
+            filterOverride = true;
+        } else if (arg == "--min-spacing" && hasValue) {
+            filter.minSpacing = static_cast<float>(std::atof(argv[++i]));
+            filterOverride = true;
+        } else if (arg == "--max-spacing" && hasValue) {
+            filter.maxSpacing = static_cast<float>(std::atof(argv[++i]));
+            filterOverride = true;
+        } else if (arg == "--max-points" && hasValue) {
+            filter.maxPoints = static_cast<size_t>(std::atoi(argv[++i]));
+            filterOverride = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<sc::InputRecord> records;
+    if (!sc::readInputLog(logPath, records)) {
+        SC_LOG(sc::LogLevel::Error, "Failed to read input log " + logPath);
+        return 1;
+    }
+
+    sc::InputManager input;
+    input.setFilterSettings(filter);
+    sc::RecognizerRouter router(models);
+    sc::ShapeScratch scratch;
+    std::vector<std::string> symbols;
+
+    sc::InputReplayer replayer;
+    if (!filterOverride && !loadDeviceProfiles(inputConfig, replayer))
+        SC_LOG(sc::LogLevel::Warn, "No input profiles in " + inputConfig + "; replaying unfiltered");
+    replayer.setPredict([&](const sc::InputManager& in) {
+        const sc::ShapeDescriptors desc = sc::describeShape(in.points(), scratch);
+        router.recognize(in.points(), desc);
+    });
+    replayer.setSubmit([&](const sc::InputManager& in) {
+        const sc::ShapeDescriptors desc = sc::describeShape(in.points(), scratch);
+        symbols.push_back(router.recognize(in.points(), desc));
+    });
+    const sc::ReplayReport report = replayer.run(records, input, options);
+
+    std::printf("events %llu  kept points %llu  gestures %llu\n",
+                static_cast<unsigned long long>(report.events),
+                static_cast<unsigned long long>(report.keptPoints),
+                static_cast<unsigned long long>(report.gestures));
+    std::printf("wall %.2f ms  throughput %.0f events/s\n", report.wallMs,
+                report.eventsPerSecond());
+    std::printf("%-8s %8s %10s %10s %10s %10s %10s\n", "stage", "count", "total ms", "p50 ms",
+                "p95 ms", "p99 ms", "max ms");
+    for (const sc::ReplayStageStats& stage : report.stages)
+        std::printf("%-8s %8llu %10.3f %10.4f %10.4f %10.4f %10.4f\n", stage.name.c_str(),
+                    static_cast<unsigned long long>(stage.count), stage.totalMs, stage.p50Ms,
+                    stage.p95Ms, stage.p99Ms, stage.maxMs);
+    for (size_t i = 0; i < symbols.size(); ++i)
+        std::printf("gesture %zu: %s\n", i + 1, symbols[i].empty() ? "-" : symbols[i].c_str());
+    return 0;
+}
@@ -1,18 +1,336 @@
 #include "core/recognition/TrocrDecoder.hpp"
 
 #include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QImage>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef SC_TROCR_BACKEND
+namespace {
+
+struct BatchOptions {
+  std::string input;  // directory of images or manifest file
+  std::string output; // CSV or JSON results; empty prints CSV to stdout
+  bool json{false};
+  int batchSize{1};
+  int workers{1};
+  int warmup{1}; // untimed batches before the timed run; 0 runs none
+};
+
+struct Sample {
+  std::string path;
+  std::string expected; // from the manifest; may be empty
+  QImage image;
+  std::string text;
+  double batchMs{0.0};   // latency of the batch that decoded this sample
+  double latencyMs{0.0}; // this sample's share of batchMs
+};
+
+std::string toUtf8(const std::u32string &text) {
+  return QString::fromUcs4(text.data(), static_cast<int>(text.size()))
+      .toStdString();
+}
+
+// A directory is scanned for images; anything else is read as a manifest
+// with one "<image path>[\t<expected text>]" per line, paths relative to the
+// manifest (the format scripts/eval_trocr.py uses).
+bool collectSamples(const std::string &input, std::vector<Sample> &samples) {
+  const QString path = QString::fromLocal8Bit(input.c_str());
+  QFileInfo info(path);
+  if (info.isDir()) {
+    QDir dir(path);
+    const QStringList names = dir.entryList(
+        {"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.pgm", "*.ppm"},
+        QDir::Files, QDir::Name);
+    for (const QString &name : names)
+      samples.push_back({dir.filePath(name).toStdString(), {}, {}, {}, 0.0, 0.0});
+    return true;
+  }
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return false;
+  const QDir base = info.absoluteDir();
+  QTextStream in(&file);
+  while (!in.atEnd()) {
+    const QString line = in.readLine();
+    if (line.trimmed().isEmpty() || line.startsWith('#'))
+      continue;
+    const int tab = line.indexOf('\t');
+    const QString image = tab < 0 ? line : line.left(tab);
+    const QString expected = tab < 0 ? QString() : line.mid(tab + 1);
+    samples.push_back({QDir::cleanPath(base.filePath(image)).toStdString(),
+                       expected.toStdString(), {}, {}, 0.0, 0.0});
+  }
+  return true;
+}
+
+double percentile(std::vector<double> values, double q) {
+  if (values.empty())
+    return 0.0;
+  size_t idx = static_cast<size_t>(q * static_cast<double>(values.size() - 1) + 0.5);
+  std::nth_element(values.begin(), values.begin() + idx, values.end());
+  return values[idx];
+}
+
+std::string csvField(const std::string &value) {
+  if (value.find_first_of(",\"\n\r") == std::string::npos)
+    return value;
+  std::string out = "\"";
+  for (char c : value) {
+    if (c == '"')
+      out += '"';
+    out += c;
+  }
+  return out + "\"";
+}
+
+std::string jsonString(const std::string &value) {
+  std::string out = "\"";
+  for (char c : value) {
+    switch (c) {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out += escaped;
+      } else {
+        out += c;
+      }
+    }
+  }
+  return out + "\"";
+}
+
+// Loads every image once, then decodes them in batches of `batchSize` on
+// `workers` threads sharing one decoder (one replica per worker). Image
+// loading and scaling are not part of the timed section.
+int runBatch(sc::TrocrDecoder &decoder, const BatchOptions &options) {
+  std::vector<Sample> samples;
+  if (!collectSamples(options.input, samples)) {
+    std::cerr << "Failed to read " << options.input << std::endl;
+    return 1;
+  }
+  const int size = decoder.expectedInputSize();
+  size_t labelled = 0;
+  for (auto &sample : samples) {
+    QImage image(QString::fromStdString(sample.path));
+    if (image.isNull()) {
+      std::cerr << "Failed to load image: " << sample.path << std::endl;
+      return 1;
+    }
+    sample.image = image.convertToFormat(QImage::Format_RGBA8888)
+                       .scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    labelled += sample.expected.empty() ? 0 : 1;
+  }
+  if (samples.empty()) {
+    std::cerr << "No images found in " << options.input << std::endl;
+    return 1;
+  }
+
+  // Loading is never timed; --warmup 0 leaves the first inference in the
+  // timed run.
+  decoder.setReplicaCount(options.workers);
+  if (!decoder.load()) {
+    std::cerr << "Failed to load the TrOCR model." << std::endl;
+    return 1;
+  }
+  const size_t batchSize = static_cast<size_t>(options.batchSize);
+  std::vector<QImage> warmupBatch;
+  for (size_t i = 0; i < std::min(batchSize, samples.size()); ++i)
+    warmupBatch.push_back(samples[i].image);
+  for (int i = 0; i < options.warmup; ++i)
+    decoder.decodeBatch(warmupBatch);
+
+  const size_t batches = (samples.size() + batchSize - 1) / batchSize;
+  std::vector<double> batchMs(batches, 0.0);
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> failed{0};
+  auto worker = [&] {
+    // Each sample is written by exactly one batch, so no locking is needed.
+    for (size_t b = next++; b < batches; b = next++) {
+      const size_t first = b * batchSize;
+      const size_t count = std::min(batchSize, samples.size() - first);
+      std::vector<QImage> images;
+      images.reserve(count);
+      for (size_t i = 0; i < count; ++i)
+        images.push_back(samples[first + i].image);
+      const auto start = std::chrono::steady_clock::now();
+      std::vector<std::u32string> texts = decoder.decodeBatch(images);
+      batchMs[b] = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+      if (texts.size() != count)
+        ++failed;
+      for (size_t i = 0; i < count; ++i) {
+        samples[first + i].batchMs = batchMs[b];
+        samples[first + i].latencyMs = batchMs[b] / static_cast<double>(count);
+        if (i < texts.size())
+          samples[first + i].text = toUtf8(texts[i]);
+      }
+    }
+  };
+  const auto wallStart = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 1; i < options.workers; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+  const double wallSec = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - wallStart)
+                             .count();
+
+  size_t exact = 0;
+  for (const auto &sample : samples) {
+    if (!sample.expected.empty() && sample.text == sample.expected)
+      ++exact;
+  }
+  const double imagesPerSec = wallSec > 0.0 ? samples.size() / wallSec : 0.0;
+  const double p50 = percentile(batchMs, 0.50);
+  const double p95 = percentile(batchMs, 0.95);
+  const double p99 = percentile(batchMs, 0.99);
+  std::vector<double> imageMs;
+  imageMs.reserve(samples.size());
+  for (const auto &sample : samples)
+    imageMs.push_back(sample.latencyMs);
+  const double imageP50 = percentile(imageMs, 0.50);
+  const double imageP95 = percentile(imageMs, 0.95);
+  const double imageP99 = percentile(imageMs, 0.99);
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output, std::ios::trunc);
+    if (!file.is_open()) {
+      std::cerr << "Failed to write " << options.output << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &out = options.output.empty() ? std::cout : file;
+  if (options.json) {
+    out << "{\"images\":" << samples.size() << ",\"batch_size\":" << batchSize
+        << ",\"workers\":" << options.workers << ",\"failed_batches\":" << failed.load()
+        << ",\"seconds\":" << wallSec << ",\"images_per_sec\":" << imagesPerSec
+        << ",\"batch_latency_ms\":{\"p50\":" << p50 << ",\"p95\":" << p95
+        << ",\"p99\":" << p99 << "},\"image_latency_ms\":{\"p50\":" << imageP50
+        << ",\"p95\":" << imageP95 << ",\"p99\":" << imageP99 << "}";
+    if (labelled > 0)
+      out << ",\"exact_match\":" << static_cast<double>(exact) / labelled;
+    out << ",\"results\":[";
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const auto &sample = samples[i];
+      out << (i ? "," : "") << "{\"path\":" << jsonString(sample.path)
+          << ",\"text\":" << jsonString(sample.text);
+      if (!sample.expected.empty())
+        out << ",\"expected\":" << jsonString(sample.expected);
+      out << ",\"latency_ms\":" << sample.latencyMs
+          << ",\"batch_latency_ms\":" << sample.batchMs << "}";
+    }
+    out << "]}\n";
+  } else {
+    out << "path,text,expected,latency_ms,batch_latency_ms\n";
+    for (const auto &sample : samples) {
+      out << csvField(sample.path) << ',' << csvField(sample.text) << ','
+          << csvField(sample.expected) << ',' << sample.latencyMs << ','
+          << sample.batchMs << '\n';
+    }
+  }
+
+  // The summary goes to stderr so stdout stays machine-readable.
+  std::fprintf(stderr,
+               "%zu images, batch %zu, %d workers: %.2f s, %.1f images/s\n"
+               "batch latency ms: p50 %.2f  p95 %.2f  p99 %.2f\n"
+               "image latency ms: p50 %.2f  p95 %.2f  p99 %.2f\n",
+               samples.size(), batchSize, options.workers, wallSec, imagesPerSec,
+               p50, p95, p99, imageP50, imageP95, imageP99);
+  if (labelled > 0)
+    std::fprintf(stderr, "exact match: %zu/%zu\n", exact, labelled);
+  if (failed > 0)
+    std::fprintf(stderr, "%zu batches failed to decode\n", failed.load());
+  return failed > 0 ? 1 : 0;
+}
+
+void printUsage() {
+  std::cerr << "Usage: trocr_infer <module.pt> <tokenizer.json> <image>\n"
+            << "       trocr_infer --onnx <model dir> <image>\n"
+            << "       trocr_infer <model args> --batch <dir|manifest> [options]\n"
+            << "Batch options:\n"
+            << "  --batch-size N   glyphs per decodeBatch call (default 1)\n"
+            << "  --workers N      concurrent decoding threads (default 1)\n"
+            << "  --warmup N       untimed warm-up batches (default 1, 0 for none)\n"
+            << "  --output FILE    write results to FILE (.json selects JSON)\n"
+            << "  --json           write JSON instead of CSV" << std::endl;
+}
+
+} // namespace
+#endif
 
 int main(int argc, char **argv) {
-#ifdef SC_ENABLE_TROCR
+#ifdef SC_TROCR_BACKEND
   QCoreApplication app(argc, argv);
   if (argc < 4) {
-    std::cerr << "Usage: trocr_infer <module.pt> <tokenizer.json> <image>" << std::endl;
+    printUsage();
     return 1;
   }
 
-  sc::TrocrDecoder decoder(argv[1], argv[2]);
+  sc::TrocrDecoder decoder;
+  if (std::strcmp(argv[1], "--onnx") == 0) {
+    decoder.setBackend(sc::TrocrDecoder::Backend::Onnx);
+    decoder.setModelPath(argv[2]);
+  } else {
+    decoder.setModelPath(argv[1]);
+    decoder.setTokenizerPath(argv[2]);
+  }
+  if (!decoder.available()) {
+    std::cerr << "This build has no backend for the requested model." << std::endl;
+    return 1;
+  }
+
+  if (std::strcmp(argv[3], "--batch") == 0) {
+    BatchOptions options;
+    for (int i = 3; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "--json") {
+        options.json = true;
+      } else if (arg == "--batch" && hasValue) {
+        options.input = argv[++i];
+      } else if (arg == "--batch-size" && hasValue) {
+        options.batchSize = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--workers" && hasValue) {
+        options.workers = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--warmup" && hasValue) {
+        options.warmup = std::max(0, std::atoi(argv[++i]));
+      } else if (arg == "--output" && hasValue) {
+        options.output = argv[++i];
+        const size_t dot = options.output.rfind('.');
+        if (dot != std::string::npos && options.output.substr(dot) == ".json")
+          options.json = true;
+      } else {
+        printUsage();
+        return 1;
+      }
+    }
+    return runBatch(decoder, options);
+  }
+
   QImage image(QString::fromLocal8Bit(argv[3]));
   if (image.isNull()) {
     std::cerr << "Failed to load image: " << argv[3] << std::endl;
@@ -23,8 +341,7 @@ int main(int argc, char **argv) {
   QImage scaled = image.scaled(decoder.expectedInputSize(), decoder.expectedInputSize(),
                                Qt::KeepAspectRatio, Qt::SmoothTransformation);
   std::u32string text = decoder.decode(scaled);
-  QString utf8 = QString::fromUcs4(text.data(), static_cast<int>(text.size()));
-  std::cout << utf8.toStdString() << std::endl;
+  std::cout << toUtf8(text) << std::endl;
   return 0;
 #else
   Q_UNUSED(argc);
@@ -0,0 +1,67 @@
+// Measures glyph preprocessing for TrOCR on its own: the fused packed-to-CHW
+// kernel against the previous per-pixel HWC fill followed by a transpose
+// (what from_blob().clone().permute() amounted to).
+#include "core/recognition/ImagePreprocess.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+void hwcThenTranspose(const uint8_t* pixels, int width, int height, size_t stride,
+                      std::vector<float>& hwc, std::vector<float>& chw) {
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* line = pixels + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* pixel = line + x * 4;
+            const size_t idx = (static_cast<size_t>(y) * width + x) * 3;
+            for (int c = 0; c < 3; ++c)
+                hwc[idx + c] = (static_cast<float>(pixel[c]) / 255.f - 0.5f) / 0.5f;
+        }
+    }
+    std::vector<float> copy(hwc); // clone()
+    const size_t plane = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < plane; ++i)
+        for (int c = 0; c < 3; ++c)
+            chw[c * plane + i] = copy[i * 3 + c];
+}
+
+template <typename F>
+double timeMs(int iterations, F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+               .count() /
+           iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int size = argc > 1 ? std::atoi(argv[1]) : 384;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+    const size_t stride = static_cast<size_t>(size) * 4;
+    std::vector<uint8_t> pixels(stride * size);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = static_cast<uint8_t>((i * 2654435761u) >> 24);
+    std::vector<float> hwc(static_cast<size_t>(size) * size * 3);
+    std::vector<float> chw(hwc.size());
+
+    volatile float sink = 0.f;
+    double baseline = timeMs(iterations, [&] {
+        hwcThenTranspose(pixels.data(), size, size, stride, hwc, chw);
+        sink = sink + chw[0];
+    });
+    double fused = timeMs(iterations, [&] {
+        sc::packedToPlanar(pixels.data(), size, size, stride, sc::PixelLayout::Rgba,
+                           sc::kTrocrNorm, chw.data());
+        sink = sink + chw[0];
+    });
+    const double mpix = static_cast<double>(size) * size / 1e6;
+    std::printf("%dx%d, %d iterations\n", size, size, iterations);
+    std::printf("  hwc + transpose: %8.3f ms  (%7.1f Mpix/s)\n", baseline, mpix / baseline * 1e3);
+    std::printf("  fused planar:    %8.3f ms  (%7.1f Mpix/s)\n", fused, mpix / fused * 1e3);
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Measures drawing one long stroke point by point: rebuilding the whole
+// QPainterPath after every point (the previous Stroke::rebuildPath()) against
+// Stroke::appendPoints(), which only adds the new segments, plus the single
+// rebuild done by finalize().
+#include "apps/desktop/Stroke.hpp"
+#include "core/input/PointBuffer.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+template <typename F>
+double timeMs(F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 10000;
+    sc::PointBuffer points;
+    for (size_t i = 0; i < count; ++i) {
+        const float t = static_cast<float>(i) * 0.01f;
+        points.push_back(200.f + 150.f * std::cos(t) + 0.02f * i,
+                         200.f + 150.f * std::sin(1.3f * t), i);
+    }
+
+    volatile double sink = 0.0;
+    const double rebuild = timeMs([&] {
+        Stroke stroke;
+        for (size_t n = 1; n <= count; ++n)
+            stroke.path = Stroke::buildPath(points.view().subview(0, n));
+        sink = sink + stroke.path.elementCount();
+    });
+    Stroke incremental;
+    const double append = timeMs([&] {
+        for (size_t n = 1; n <= count; ++n)
+            incremental.appendPoints(points.view().subview(0, n));
+        sink = sink + incremental.path.elementCount();
+    });
+    const double finalize = timeMs([&] {
+        incremental.finalize(points.view());
+        sink = sink + incremental.path.elementCount();
+    });
+
+    const QPainterPath reference = Stroke::buildPath(points.view());
+    const bool same = reference == incremental.path;
+    std::printf("%zu points, one path update per point\n", count);
+    std::printf("  full rebuild:  %10.2f ms  (%8.3f us/point)\n", rebuild,
+                rebuild * 1e3 / count);
+    std::printf("  incremental:   %10.2f ms  (%8.3f us/point)\n", append,
+                append * 1e3 / count);
+    std::printf("  finalize:      %10.2f ms  (path %s)\n", finalize,
+                same ? "matches buildPath" : "DIFFERS from buildPath");
+    return same ? 0 : 1;
+}
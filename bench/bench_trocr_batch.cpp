@@ -0,0 +1,83 @@
+// Throughput of TrocrDecoder::decodeBatch on CPU for batch sizes 1-32,
+// against the same glyphs decoded one call at a time.
+//
+//   bench_trocr_batch <module.pt> <tokenizer.json> [rounds]
+#include "core/recognition/TrocrDecoder.hpp"
+
+#include <QImage>
+#include <QPainter>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+// Simple synthetic strokes so every glyph differs a little.
+QImage makeGlyph(int size, int seed) {
+  QImage image(size, size, QImage::Format_RGBA8888);
+  image.fill(Qt::white);
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing, true);
+  painter.setPen(QPen(Qt::black, size / 40.0, Qt::SolidLine, Qt::RoundCap));
+  const double c = size / 2.0;
+  const double r = size * (0.2 + 0.02 * (seed % 5));
+  painter.drawLine(QPointF(c - r, c + r), QPointF(c, c - r));
+  painter.drawLine(QPointF(c, c - r), QPointF(c + r, c + r));
+  if (seed % 2)
+    painter.drawLine(QPointF(c - r / 2, c), QPointF(c + r / 2, c));
+  painter.end();
+  return image;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+#ifdef SC_ENABLE_TROCR
+  if (argc < 3) {
+    std::fprintf(stderr, "Usage: bench_trocr_batch <module.pt> <tokenizer.json> [rounds]\n");
+    return 1;
+  }
+  const int rounds = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+  sc::TrocrDecoder decoder(argv[1], argv[2]);
+  if (!decoder.warmUp()) {
+    std::fprintf(stderr, "Failed to load the TrOCR module or tokenizer\n");
+    return 1;
+  }
+  const int size = decoder.expectedInputSize();
+  std::vector<QImage> glyphs;
+  for (int i = 0; i < 32; ++i)
+    glyphs.push_back(makeGlyph(size, i));
+
+  std::printf("%6s %14s %14s %14s\n", "batch", "batched ms", "glyphs/s", "sequential/s");
+  for (size_t batch = 1; batch <= 32; batch *= 2) {
+    double batchedMs = 0.0;
+    double sequentialMs = 0.0;
+    for (int r = 0; r < rounds; ++r) {
+      auto start = std::chrono::steady_clock::now();
+      decoder.decodeBatch(glyphs.data(), batch);
+      batchedMs += elapsedMs(start);
+      start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < batch; ++i)
+        decoder.decode(glyphs[i]);
+      sequentialMs += elapsedMs(start);
+    }
+    batchedMs /= rounds;
+    sequentialMs /= rounds;
+    std::printf("%6zu %14.2f %14.1f %14.1f\n", batch, batchedMs,
+                batch * 1000.0 / batchedMs, batch * 1000.0 / sequentialMs);
+  }
+  return 0;
+#else
+  (void)argc;
+  (void)argv;
+  std::fprintf(stderr, "TrOCR support is disabled at build time.\n");
+  return 1;
+#endif
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "InputManager.hpp"
+
+namespace sc {
+
+// Consumer side of an InputEventRing: drains it on its own thread and hands
+// each complete gesture (the points between a Begin and its End, halved on
+// each Thin like InputManager's copy) to a callback, so recognition runs
+// while the producing thread keeps capturing.
+// The ring has no blocking wait, so an idle worker sleeps for `idlePoll`
+// between checks. The gesture buffer is reused, so the steady state does
+// not allocate once it has grown to the longest gesture.
+class InputEventWorker {
+public:
+    using GestureFn = std::function<void(const PointBuffer&)>;
+
+    InputEventWorker(InputEventRing& ring, GestureFn onGesture,
+                     std::chrono::microseconds idlePoll = std::chrono::microseconds(500))
+        : m_ring(ring), m_onGesture(std::move(onGesture)), m_idlePoll(idlePoll) {
+        m_thread = std::thread([this] { run(); });
+    }
+
+    ~InputEventWorker() { stop(); }
+
+    InputEventWorker(const InputEventWorker&) = delete;
+    InputEventWorker& operator=(const InputEventWorker&) = delete;
+
+    // Returns once every event pushed before the call has been handled.
+    void stop() {
+        m_stopping.store(true, std::memory_order_release);
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    uint64_t gestureCount() const { return m_gestures.load(std::memory_order_relaxed); }
+
+private:
+    void run() {
+        for (;;) {
+            // Read the flag before draining, so events pushed before stop()
+            // are drained before the loop exits.
+            const bool stopping = m_stopping.load(std::memory_order_acquire);
+            const size_t handled = m_ring.drain([this](const InputEvent& e) { handle(e); });
+            if (handled == 0) {
+                if (stopping)
+                    return;
+                std::this_thread::sleep_for(m_idlePoll);
+            }
+        }
+    }
+
+    void handle(const InputEvent& e) {
+        switch (e.type) {
+        case InputEvent::Type::Begin:
+            // A Begin without the previous End means that gesture was
+            // discarded by the producer.
+            m_gesture.clear();
+            m_open = true;
+            break;
+        case InputEvent::Type::Point:
+            if (m_open)
+                m_gesture.push_back(e.point.x, e.point.y);
+            break;
+        case InputEvent::Type::Thin:
+            if (m_open)
+                m_gesture.halve();
+            break;
+        case InputEvent::Type::End:
+            if (m_open) {
+                if (m_onGesture)
+                    m_onGesture(m_gesture);
+                m_gestures.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_gesture.clear();
+            m_open = false;
+            break;
+        }
+    }
+
+    InputEventRing& m_ring;
+    GestureFn m_onGesture;
+    std::chrono::microseconds m_idlePoll;
+    PointBuffer m_gesture;
+    bool m_open{false};
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint64_t> m_gestures{0};
+    std::thread m_thread;
+};
+
+} // namespace sc
@@ -0,0 +1,202 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace sc {
+
+// One Euro low-pass filter (Casiez et al.): the cutoff frequency rises with
+// the signal's speed, so slow movement is smoothed strongly while fast
+// strokes keep up without lag.
+class OneEuroFilter {
+public:
+    OneEuroFilter(double minCutoff = 1.0, double beta = 0.007, double derivativeCutoff = 1.0)
+        : m_minCutoff(minCutoff), m_beta(beta), m_derivativeCutoff(derivativeCutoff) {}
+
+    double filter(double value, double dtSeconds) {
+        if (!m_initialized) {
+            m_initialized = true;
+            m_value = value;
+            m_derivative = 0.0;
+            return value;
+        }
+        if (dtSeconds <= 0.0)
+            dtSeconds = kDefaultDt;
+        const double rawDerivative = (value - m_value) / dtSeconds;
+        m_derivative += alpha(m_derivativeCutoff, dtSeconds) * (rawDerivative - m_derivative);
+        const double cutoff = m_minCutoff + m_beta * std::fabs(m_derivative);
+        m_value += alpha(cutoff, dtSeconds) * (value - m_value);
+        return m_value;
+    }
+
+    void reset() { m_initialized = false; }
+
+private:
+    static constexpr double kDefaultDt = 1.0 / 120.0;
+
+    static double alpha(double cutoff, double dt) {
+        const double tau = 1.0 / (2.0 * 3.14159265358979323846 * cutoff);
+        return 1.0 / (1.0 + tau / dt);
+    }
+
+    double m_minCutoff;
+    double m_beta;
+    double m_derivativeCutoff;
+    double m_value{0.0};
+    double m_derivative{0.0};
+    bool m_initialized{false};
+};
+
+// Ingestion settings for one kind of input device. Everything is off by
+// default, so an unconfigured InputManager stores every raw point.
+struct InputFilterSettings {
+    // One Euro smoothing; see OneEuroFilter.
+    bool smoothing{false};
+    double minCutoff{1.0};
+    double beta{0.007};
+    double derivativeCutoff{1.0};
+
+    // Points closer than minSpacing to the last kept point are dropped. While
+    // the direction changes by less than turnDegrees, points are only kept
+    // every maxSpacing, so straight runs are sparse and corners stay dense;
+    // a corner is cut by at most maxSpacing * tan(turnDegrees). 0 disables
+    // the rule.
+    float minSpacing{0.f};
+    float maxSpacing{0.f};
+    float turnDegrees{8.f};
+
+    // Upper bound on the points kept per gesture (0 = unlimited; values below
+    // 3 are ignored). Reaching it halves the gesture and doubles the spacing
+    // for the rest of it.
+    size_t maxPoints{0};
+
+    bool enabled() const { return smoothing || minSpacing > 0.f || maxPoints > 0; }
+};
+
+// Raw and kept point counts for a gesture or a session.
+struct InputFilterStats {
+    uint64_t raw{0};
+    uint64_t kept{0};
+
+    // Fraction of raw points that were dropped.
+    double reductionRatio() const {
+        return raw == 0 ? 0.0 : 1.0 - static_cast<double>(kept) / static_cast<double>(raw);
+    }
+};
+
+// Smoothing and decimation applied to each captured point before it is
+// stored. push() reports whether the (smoothed) point should be kept;
+// finish() returns the gesture's last point and its timestamp if it was
+// dropped, so the endpoint survives decimation.
+class InputFilter {
+public:
+    InputFilter() = default;
+    explicit InputFilter(const InputFilterSettings& settings) { setSettings(settings); }
+
+    void setSettings(const InputFilterSettings& settings) {
+        m_settings = settings;
+        begin();
+    }
+
+    const InputFilterSettings& settings() const { return m_settings; }
+
+    // Starts a new gesture.
+    void begin() {
+        m_x = OneEuroFilter(m_settings.minCutoff, m_settings.beta, m_settings.derivativeCutoff);
+        m_y = m_x;
+        m_kept = 0;
+        m_scale = 1.f;
+        m_hasPending = false;
+        m_started = false;
+        m_lastTimestamp = 0;
+    }
+
+    bool push(float x, float y, uint64_t timestampMs, float& outX, float& outY) {
+        if (m_settings.smoothing) {
+            // Missing or repeated timestamps fall back to the filter's
+            // default frame interval.
+            double dt = 0.0;
+            if (m_started && timestampMs > m_lastTimestamp)
+                dt = static_cast<double>(timestampMs - m_lastTimestamp) / 1000.0;
+            x = static_cast<float>(m_x.filter(x, dt));
+            y = static_cast<float>(m_y.filter(y, dt));
+        }
+        m_started = true;
+        m_lastTimestamp = timestampMs;
+        outX = x;
+        outY = y;
+        if (!keep(x, y)) {
+            m_hasPending = true;
+            m_pendingX = x;
+            m_pendingY = y;
+            m_pendingTimestamp = timestampMs;
+            return false;
+        }
+        m_hasPending = false;
+        m_prevX = m_lastX;
+        m_prevY = m_lastY;
+        m_lastX = x;
+        m_lastY = y;
+        ++m_kept;
+        return true;
+    }
+
+    // The last point pushed, if push() dropped it.
+    bool finish(float& x, float& y, uint64_t& timestampMs) {
+        if (!m_hasPending)
+            return false;
+        m_hasPending = false;
+        x = m_pendingX;
+        y = m_pendingY;
+        timestampMs = m_pendingTimestamp;
+        return true;
+    }
+
+    // Called after the owner halved the gesture's kept points at maxPoints.
+    void widen(size_t keptAfterThinning) {
+        m_kept = keptAfterThinning;
+        m_scale *= 2.f;
+    }
+
+private:
+    bool keep(float x, float y) const {
+        const float minSpacing = m_settings.minSpacing * m_scale;
+        if (m_kept == 0 || minSpacing <= 0.f)
+            return true;
+        const float dx = x - m_lastX;
+        const float dy = y - m_lastY;
+        const float dist = std::sqrt(dx * dx + dy * dy);
+        if (dist < minSpacing)
+            return false;
+        const float maxSpacing = m_settings.maxSpacing * m_scale;
+        if (m_kept < 2 || maxSpacing <= minSpacing || dist >= maxSpacing)
+            return true;
+        // Keep turning points; skip ones that continue the last segment.
+        const float sx = m_lastX - m_prevX;
+        const float sy = m_lastY - m_prevY;
+        const float segment = std::sqrt(sx * sx + sy * sy);
+        if (segment == 0.f)
+            return true;
+        const float cosTurn = (sx * dx + sy * dy) / (segment * dist);
+        const float cosLimit = std::cos(m_settings.turnDegrees * 3.14159265f / 180.f);
+        return cosTurn < cosLimit;
+    }
+
+    InputFilterSettings m_settings;
+    OneEuroFilter m_x;
+    OneEuroFilter m_y;
+    size_t m_kept{0};
+    float m_scale{1.f};
+    float m_lastX{0.f};
+    float m_lastY{0.f};
+    float m_prevX{0.f};
+    float m_prevY{0.f};
+    bool m_hasPending{false};
+    bool m_started{false};
+    float m_pendingX{0.f};
+    float m_pendingY{0.f};
+    uint64_t m_pendingTimestamp{0};
+    uint64_t m_lastTimestamp{0};
+};
+
+} // namespace sc
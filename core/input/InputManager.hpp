@@ -6,16 +6,26 @@
 #include <utility>
 #include <vector>
 
-// TODO: hook InputManager into real OS events and add gesture smoothing
+#include "InputFilter.hpp"
+#include "PointBuffer.hpp"
+#include "SpscRing.hpp"
+
+// TODO: hook InputManager into real OS events
 
 namespace sc {
 
-// Simple 2D point
-struct Point {
-    float x;
-    float y;
+// Raw capture event streamed to a recognition worker through an
+// InputEventRing: Begin and End bracket each gesture's Point events. Thin
+// tells the consumer that the gesture hit maxPoints and was halved
+// (PointBuffer::halve()) at that point in the stream.
+struct InputEvent {
+    enum class Type : uint8_t { Begin, Point, End, Thin };
+    Type type;
+    sc::Point point;
 };
 
+using InputEventRing = SpscRing<InputEvent>;
+
 // InputManager records gesture points for later recognition or training.
 enum class TapAction {
     None,
@@ -113,38 +123,180 @@ public:
 
     void startCapture() {
         m_points.clear();
+        m_filter.begin();
+        m_gestureRaw = 0;
+        m_pendingThins = 0;
         m_capturing = true;
+        publish(InputEvent::Type::Begin, {0.f, 0.f});
     }
 
-    void stopCapture() { m_capturing = false; }
+    void stopCapture() {
+        if (m_capturing) {
+            float x = 0.f;
+            float y = 0.f;
+            uint64_t timestampMs = 0;
+            if (m_filter.finish(x, y, timestampMs))
+                store(x, y, timestampMs, m_droppedPressure);
+            m_session.raw += m_gestureRaw;
+            m_session.kept += m_points.size();
+            publish(InputEvent::Type::End, {0.f, 0.f});
+        }
+        m_capturing = false;
+    }
+
+    // Also streams captured events into `ring` (not owned; nullptr stops),
+    // so a worker thread can consume gestures while capture continues. The
+    // thread calling addPoint() is the ring's only producer. Points that do
+    // not fit are dropped and counted by the ring; Begin and End are not
+    // (see publish()). Detaching mid-gesture closes it with an End.
+    void setEventRing(InputEventRing* ring) {
+        if (m_ring && m_ringOpen)
+            publish(InputEvent::Type::End, {0.f, 0.f});
+        m_ring = ring;
+    }
 
     bool capturing() const { return m_capturing; }
 
     void setDoubleTapInterval(uint64_t interval) { m_doubleTapInterval = interval; }
 
-    void addPoint(float x, float y) {
-        if (m_capturing)
-            m_points.push_back({x, y});
+    // Smoothing and decimation for the points of later gestures; the
+    // defaults store every raw point unchanged.
+    void setFilterSettings(const InputFilterSettings& settings) { m_filter.setSettings(settings); }
+
+    const InputFilterSettings& filterSettings() const { return m_filter.settings(); }
+
+    // Raw and kept points of the current (or last) gesture.
+    InputFilterStats gestureStats() const { return {m_gestureRaw, m_points.size()}; }
+
+    // Totals over all finished gestures.
+    const InputFilterStats& sessionStats() const { return m_session; }
+
+    // Starts a new stroke: later points carry the returned id. Ids keep
+    // increasing across gestures, so a stroke id is never reused while a
+    // caller may still refer to it.
+    uint32_t beginStroke() { return ++m_strokeId; }
+
+    // Id of the stroke new points are added to.
+    uint32_t strokeId() const { return m_strokeId; }
+
+    // Returns true if the point was kept; points().back() then holds it as
+    // stored (smoothed). Dropped points are not streamed to the event ring.
+    bool addPoint(float x, float y) {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return addPoint(x, y,
+                        static_cast<uint64_t>(
+                            std::chrono::duration_cast<std::chrono::milliseconds>(now).count()));
+    }
+
+    bool addPoint(float x, float y, uint64_t timestampMs, float pressure = 1.f) {
+        if (!m_capturing)
+            return false;
+        ++m_gestureRaw;
+        if (!m_filter.push(x, y, timestampMs, x, y)) {
+            m_droppedPressure = pressure; // in case stopCapture() keeps it
+            return false;
+        }
+        store(x, y, timestampMs, pressure);
+        return true;
     }
 
-    const std::vector<Point>& points() const { return m_points; }
+    // Views into buffer(); invalidated by the next addPoint().
+    PointView points() const { return m_points.view(); }
+
+    // All columns of the captured gesture (timestamps, pressure, stroke ids)
+    // for consumers that need more than positions.
+    const PointBuffer& buffer() const { return m_points; }
 
     void clear() { m_points.clear(); }
 
     // Simple console animation to visualize the path.
     void playbackPath() const {
-        for (const auto& p : m_points) {
+        for (const Point p : m_points.view()) {
             std::cout << "Point(" << p.x << ", " << p.y << ")" << std::endl;
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
     }
 
 private:
+    void store(float x, float y, uint64_t timestampMs, float pressure) {
+        const size_t cap = m_filter.settings().maxPoints;
+        if (cap > 2 && m_points.size() >= cap)
+            thin();
+        m_points.push_back(x, y, timestampMs, pressure, m_strokeId);
+        publish(InputEvent::Type::Point, {x, y});
+    }
+
+    // Drops every other point (keeping both ends) and makes the filter's
+    // spacing coarser, so long gestures stay under maxPoints with their
+    // overall shape intact. The ring's consumer halves its copy on the Thin
+    // event, so both end up with the same points.
+    void thin() {
+        m_points.halve();
+        m_filter.widen(m_points.size());
+        publish(InputEvent::Type::Thin, {0.f, 0.f});
+    }
+
+    // Keeps gestures bracketed when the ring fills up. Points, Thin and Begin
+    // leave one slot free, so the End of a gesture whose Begin went in always
+    // fits. A Begin that does not fit is retried before the gesture's next
+    // point; if it never fits, the whole gesture is skipped. Either way the
+    // consumer sees gestures with missing points, never two run together.
+    // A Thin that does not fit is also retried before the next point, and
+    // that point is dropped if it still does not fit, so the consumer halves
+    // its gesture at the same place in the stream.
+    void publish(InputEvent::Type type, Point point) {
+        if (!m_ring)
+            return;
+        switch (type) {
+        case InputEvent::Type::Begin:
+            m_ringOpen = m_ring->tryPush({type, point}, 1);
+            break;
+        case InputEvent::Type::Point:
+            if (!m_ringOpen)
+                m_ringOpen = m_ring->tryPush({InputEvent::Type::Begin, {0.f, 0.f}}, 1);
+            if (m_ringOpen && flushThins())
+                m_ring->tryPush({type, point}, 1);
+            break;
+        case InputEvent::Type::Thin:
+            // Before the gesture's Begin went in, the consumer has no points
+            // to halve.
+            if (m_ringOpen) {
+                ++m_pendingThins;
+                flushThins();
+            }
+            break;
+        case InputEvent::Type::End:
+            if (m_ringOpen) {
+                flushThins();
+                m_ring->tryPush({type, point});
+            }
+            m_ringOpen = false;
+            m_pendingThins = 0;
+            break;
+        }
+    }
+
+    // Pushes deferred Thin events; false if some are still pending.
+    bool flushThins() {
+        while (m_pendingThins > 0 &&
+               m_ring->tryPush({InputEvent::Type::Thin, {0.f, 0.f}}, 1))
+            --m_pendingThins;
+        return m_pendingThins == 0;
+    }
+
     bool m_capturing;
     uint64_t m_lastTap;
     uint64_t m_doubleTapInterval;
-    std::vector<Point> m_points;
+    PointBuffer m_points;
+    uint32_t m_strokeId{0};
     unsigned m_tapCount;
+    InputEventRing* m_ring{nullptr};
+    bool m_ringOpen{false}; // a Begin is in the ring without its End
+    unsigned m_pendingThins{0}; // Thin events still to be pushed
+    InputFilter m_filter;
+    uint64_t m_gestureRaw{0};
+    float m_droppedPressure{1.f};
+    InputFilterStats m_session;
 };
 
 } // namespace sc
@@ -0,0 +1,260 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "InputManager.hpp"
+
+namespace sc {
+
+// A gesture one device finished with a double tap, as handed to the
+// recognition workers.
+struct DeviceGesture {
+    uint32_t device{0};
+    PointBuffer points;
+};
+
+struct InputMultiplexerStats {
+    uint64_t submitted{0}; // gestures queued for recognition
+    uint64_t recognized{0};
+    uint64_t dropped{0}; // gestures rejected because the queue was full
+    size_t devices{0};
+};
+
+// Routes input from several simultaneous devices (pointers, pens, VR
+// controllers) to one InputManager per device id, so each device has its own
+// tap state machine and point buffer and concurrent gestures cannot corrupt
+// each other. Taps and moves follow the canvas: a double tap starts a
+// sequence at the tap position, taps and moves while capturing add points,
+// and the double tap that ends the sequence queues the gesture.
+//
+// Finished gestures go to one shared queue served by a pool of recognition
+// workers. Like ShadowEvaluator, the queue is bounded and drops (and counts)
+// gestures instead of blocking input when recognition falls behind.
+//
+// Events for different devices may come from different threads: the device
+// table is only locked exclusively when a device first appears or is
+// removed, and each device's state has its own lock. A device may be removed
+// while other threads feed it; events that lose the race start the device
+// over with fresh state.
+class InputMultiplexer {
+public:
+    using RecognizeFn = std::function<void(const DeviceGesture&)>;
+
+    explicit InputMultiplexer(RecognizeFn recognize, size_t workers = 1, size_t maxQueue = 256)
+        : m_recognize(std::move(recognize)), m_maxQueue(maxQueue) {
+        if (workers == 0)
+            workers = 1;
+        for (size_t i = 0; i < workers; ++i)
+            m_workers.emplace_back([this] { workerLoop(); });
+    }
+
+    // Recognizes the gestures still queued, then stops the workers.
+    ~InputMultiplexer() {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_stopping = true;
+        }
+        m_queueCv.notify_all();
+        for (std::thread& worker : m_workers)
+            worker.join();
+    }
+
+    InputMultiplexer(const InputMultiplexer&) = delete;
+    InputMultiplexer& operator=(const InputMultiplexer&) = delete;
+
+    // Filter settings for devices seen from now on.
+    void setDefaultFilterSettings(const InputFilterSettings& settings) {
+        std::unique_lock<std::shared_mutex> lock(m_devicesMutex);
+        m_defaultFilter = settings;
+    }
+
+    void setFilterSettings(uint32_t device, const InputFilterSettings& settings) {
+        std::unique_lock<std::mutex> lock;
+        lockShard(device, lock)->input.setFilterSettings(settings);
+    }
+
+    TapAction onTap(uint32_t device, uint64_t timestampMs, float x, float y) {
+        std::unique_lock<std::mutex> lock;
+        const std::shared_ptr<Shard> shard = lockShard(device, lock);
+        const TapAction act = shard->input.onTapSequence(timestampMs);
+        if (act == TapAction::StartSequence) {
+            shard->input.beginStroke();
+            shard->input.addPoint(x, y, timestampMs);
+        } else if (act == TapAction::EndSequence) {
+            DeviceGesture gesture{device, shard->input.buffer()};
+            shard->input.clear();
+            lock.unlock();
+            enqueue(std::move(gesture));
+        } else if (act == TapAction::None && shard->input.capturing()) {
+            shard->input.addPoint(x, y, timestampMs);
+        }
+        return act;
+    }
+
+    // Returns true if the point was kept for the device's current gesture.
+    bool onMove(uint32_t device, float x, float y, uint64_t timestampMs, float pressure = 1.f) {
+        std::unique_lock<std::mutex> lock;
+        return lockShard(device, lock)->input.addPoint(x, y, timestampMs, pressure);
+    }
+
+    // Starts a new stroke within the device's gesture.
+    void beginStroke(uint32_t device) {
+        std::unique_lock<std::mutex> lock;
+        lockShard(device, lock)->input.beginStroke();
+    }
+
+    bool capturing(uint32_t device) const {
+        std::shared_ptr<Shard> shard = findShard(device);
+        if (!shard)
+            return false;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        return !shard->removed && shard->input.capturing();
+    }
+
+    // Forgets a disconnected device and any gesture it left unfinished. Safe
+    // while other threads feed the device: an event already holding the
+    // device's state finishes first, and later events start it over.
+    void removeDevice(uint32_t device) {
+        std::shared_ptr<Shard> shard;
+        {
+            std::unique_lock<std::shared_mutex> lock(m_devicesMutex);
+            auto it = m_shards.find(device);
+            if (it == m_shards.end())
+                return;
+            shard = std::move(it->second);
+            m_shards.erase(it);
+        }
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->removed = true;
+    }
+
+    size_t deviceCount() const {
+        std::shared_lock<std::shared_mutex> lock(m_devicesMutex);
+        return m_shards.size();
+    }
+
+    // Blocks until every queued gesture has been recognized.
+    void waitIdle() const {
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        m_idleCv.wait(lock, [this] { return m_queue.empty() && m_busy == 0; });
+    }
+
+    InputMultiplexerStats stats() const {
+        InputMultiplexerStats s;
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            s.submitted = m_submitted;
+            s.recognized = m_recognized;
+            s.dropped = m_dropped;
+        }
+        s.devices = deviceCount();
+        return s;
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        InputManager input;
+        bool removed{false}; // set under `mutex` by removeDevice()
+    };
+
+    std::shared_ptr<Shard> findShard(uint32_t device) const {
+        std::shared_lock<std::shared_mutex> lock(m_devicesMutex);
+        auto it = m_shards.find(device);
+        return it == m_shards.end() ? nullptr : it->second;
+    }
+
+    // Callers hold a reference, so a shard outlives its removal from the
+    // table.
+    std::shared_ptr<Shard> shardFor(uint32_t device) {
+        if (std::shared_ptr<Shard> shard = findShard(device))
+            return shard;
+        std::unique_lock<std::shared_mutex> lock(m_devicesMutex);
+        std::shared_ptr<Shard>& slot = m_shards[device];
+        if (!slot) {
+            slot = std::make_shared<Shard>();
+            slot->input.setFilterSettings(m_defaultFilter);
+        }
+        return slot;
+    }
+
+    // Returns the device's shard with `lock` holding its mutex. If the device
+    // was removed while this thread waited for the lock, retries on the shard
+    // that replaces it.
+    std::shared_ptr<Shard> lockShard(uint32_t device, std::unique_lock<std::mutex>& lock) {
+        for (;;) {
+            std::shared_ptr<Shard> shard = shardFor(device);
+            lock = std::unique_lock<std::mutex>(shard->mutex);
+            if (!shard->removed)
+                return shard;
+            lock.unlock();
+        }
+    }
+
+    void enqueue(DeviceGesture&& gesture) {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (m_stopping)
+                return;
+            if (m_queue.size() >= m_maxQueue) {
+                ++m_dropped;
+                return;
+            }
+            ++m_submitted;
+            m_queue.push_back(std::move(gesture));
+        }
+        m_queueCv.notify_one();
+    }
+
+    void workerLoop() {
+        for (;;) {
+            DeviceGesture gesture;
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                m_queueCv.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty())
+                    return;
+                gesture = std::move(m_queue.front());
+                m_queue.pop_front();
+                ++m_busy;
+            }
+            if (m_recognize)
+                m_recognize(gesture);
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                --m_busy;
+                ++m_recognized;
+            }
+            m_idleCv.notify_all();
+        }
+    }
+
+    RecognizeFn m_recognize;
+    size_t m_maxQueue;
+
+    mutable std::shared_mutex m_devicesMutex;
+    std::unordered_map<uint32_t, std::shared_ptr<Shard>> m_shards;
+    InputFilterSettings m_defaultFilter;
+
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queueCv;
+    mutable std::condition_variable m_idleCv;
+    std::deque<DeviceGesture> m_queue;
+    bool m_stopping{false};
+    size_t m_busy{0};
+    uint64_t m_submitted{0};
+    uint64_t m_recognized{0};
+    uint64_t m_dropped{0};
+    std::vector<std::thread> m_workers;
+};
+
+} // namespace sc
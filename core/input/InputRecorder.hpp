@@ -0,0 +1,196 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace sc {
+
+enum class InputDevice : uint8_t { Mouse, Touch, Pen, Vr };
+
+// One raw input event as the canvas hands it to InputManager: a tap goes to
+// onTapSequence(), a move to addPoint().
+struct InputRecord {
+    enum class Type : uint8_t { Tap, Move };
+    Type type{Type::Move};
+    InputDevice device{InputDevice::Mouse};
+    uint64_t timestampMs{0}; // since the start of the recording
+    float x{0.f};
+    float y{0.f};
+};
+
+// Writes raw input events to a compact binary log. Little-endian layout:
+//
+//   "SCIL" u32 version u64 startEpochMs
+//   per event: u8 (type << 4 | device) varint deltaMs f32 x f32 y
+//
+// where deltaMs is the time since the previous event, so a typical move
+// takes 10 bytes. Events are buffered and written in blocks.
+class InputRecorder {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    InputRecorder() = default;
+    explicit InputRecorder(const std::string& path) { open(path); }
+    ~InputRecorder() { close(); }
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        m_out.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_out.is_open())
+            return false;
+        m_start = std::chrono::steady_clock::now();
+        m_last = 0;
+        const uint64_t epochMs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count());
+        m_buffer.assign({'S', 'C', 'I', 'L'});
+        putU32(kVersion);
+        putU64(epochMs);
+        return true;
+    }
+
+    bool isOpen() const { return m_out.is_open(); }
+    uint64_t eventCount() const { return m_events; }
+
+    // Stamps the event with the time since open().
+    void record(InputRecord::Type type, InputDevice device, float x, float y) {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        record(type, device,
+               static_cast<uint64_t>(
+                   std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()),
+               x, y);
+    }
+
+    // Timestamps earlier than the previous event are clamped to it.
+    void record(InputRecord::Type type, InputDevice device, uint64_t timestampMs, float x,
+                float y) {
+        if (!m_out.is_open())
+            return;
+        if (timestampMs < m_last)
+            timestampMs = m_last;
+        m_buffer.push_back(static_cast<char>((static_cast<uint8_t>(type) << 4) |
+                                             (static_cast<uint8_t>(device) & 0x0f)));
+        uint64_t delta = timestampMs - m_last;
+        while (delta >= 0x80) {
+            m_buffer.push_back(static_cast<char>((delta & 0x7f) | 0x80));
+            delta >>= 7;
+        }
+        m_buffer.push_back(static_cast<char>(delta));
+        putF32(x);
+        putF32(y);
+        m_last = timestampMs;
+        ++m_events;
+        if (m_buffer.size() >= kFlushBytes)
+            flush();
+    }
+
+    void flush() {
+        if (!m_out.is_open() || m_buffer.empty())
+            return;
+        m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_out.flush();
+        m_buffer.clear();
+    }
+
+    void close() {
+        flush();
+        if (m_out.is_open())
+            m_out.close();
+    }
+
+private:
+    static constexpr size_t kFlushBytes = 64 * 1024;
+
+    void putU32(uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            m_buffer.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+    void putU64(uint64_t v) {
+        for (int i = 0; i < 8; ++i)
+            m_buffer.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+    void putF32(float f) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &f, sizeof(bits));
+        putU32(bits);
+    }
+
+    std::ofstream m_out;
+    std::vector<char> m_buffer;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_last{0};
+    uint64_t m_events{0};
+};
+
+// Reads a log written by InputRecorder. Returns false (and leaves `out`
+// empty) for a missing or malformed file; a log cut short mid-event keeps
+// the events before the cut.
+inline bool readInputLog(const std::string& path, std::vector<InputRecord>& out,
+                         uint64_t* startEpochMs = nullptr) {
+    out.clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return false;
+    const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(in)),
+                                           std::istreambuf_iterator<char>());
+    if (bytes.size() < 16 || std::memcmp(bytes.data(), "SCIL", 4) != 0)
+        return false;
+    auto u32At = [&](size_t pos) {
+        return static_cast<uint32_t>(bytes[pos]) | (static_cast<uint32_t>(bytes[pos + 1]) << 8) |
+               (static_cast<uint32_t>(bytes[pos + 2]) << 16) |
+               (static_cast<uint32_t>(bytes[pos + 3]) << 24);
+    };
+    if (u32At(4) != InputRecorder::kVersion)
+        return false;
+    if (startEpochMs)
+        *startEpochMs = static_cast<uint64_t>(u32At(8)) | (static_cast<uint64_t>(u32At(12)) << 32);
+
+    size_t pos = 16;
+    uint64_t timestamp = 0;
+    while (pos < bytes.size()) {
+        const uint8_t tag = bytes[pos++];
+        const uint8_t type = tag >> 4;
+        const uint8_t device = tag & 0x0f;
+        if (type > static_cast<uint8_t>(InputRecord::Type::Move) ||
+            device > static_cast<uint8_t>(InputDevice::Vr)) {
+            out.clear();
+            return false;
+        }
+        uint64_t delta = 0;
+        int shift = 0;
+        bool complete = false;
+        while (pos < bytes.size() && shift < 64) {
+            const uint8_t b = bytes[pos++];
+            delta |= static_cast<uint64_t>(b & 0x7f) << shift;
+            shift += 7;
+            if (!(b & 0x80)) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete || bytes.size() - pos < 8)
+            break;
+        InputRecord record;
+        record.type = static_cast<InputRecord::Type>(type);
+        record.device = static_cast<InputDevice>(device);
+        timestamp += delta;
+        record.timestampMs = timestamp;
+        const uint32_t xBits = u32At(pos);
+        const uint32_t yBits = u32At(pos + 4);
+        std::memcpy(&record.x, &xBits, sizeof(float));
+        std::memcpy(&record.y, &yBits, sizeof(float));
+        pos += 8;
+        out.push_back(record);
+    }
+    return true;
+}
+
+} // namespace sc
@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InputManager.hpp"
+#include "InputRecorder.hpp"
+
+namespace sc {
+
+struct ReplayOptions {
+    // Sleep until each event's recorded time instead of feeding events back
+    // to back; `speed` scales the recorded timeline (2 = twice as fast).
+    bool realtime{false};
+    double speed{1.0};
+};
+
+// Latency of one pipeline stage over a replay, in milliseconds.
+struct ReplayStageStats {
+    std::string name;
+    uint64_t count{0};
+    double totalMs{0.0};
+    double p50Ms{0.0};
+    double p95Ms{0.0};
+    double p99Ms{0.0};
+    double maxMs{0.0};
+};
+
+struct ReplayReport {
+    uint64_t events{0};
+    uint64_t keptPoints{0};
+    uint64_t gestures{0};
+    double wallMs{0.0};
+    std::vector<ReplayStageStats> stages; // ingest, predict, submit
+
+    double eventsPerSecond() const {
+        return wallMs > 0.0 ? static_cast<double>(events) * 1000.0 / wallMs : 0.0;
+    }
+};
+
+// Feeds a recorded input log through an InputManager the way CanvasWindow
+// does: taps drive onTapSequence(), a started sequence opens a stroke at the
+// tap position, moves are captured while a sequence is active, and each kept
+// point runs the predict stage. A finished sequence runs the submit stage
+// on the captured gesture. Recognition is left to the callbacks so the
+// replayer stays independent of the recognizers and the UI.
+//
+// With device profiles set, a tap outside a gesture also switches the input
+// manager to the filter settings of the tap's device, as the canvas does
+// when a press comes from a different device.
+class InputReplayer {
+public:
+    using StageFn = std::function<void(const InputManager&)>;
+
+    void setPredict(StageFn fn) { m_predict = std::move(fn); }
+    void setSubmit(StageFn fn) { m_submit = std::move(fn); }
+
+    // Filter settings for `device`'s gestures. Once any device has a
+    // profile, devices without one replay unfiltered; until then the input
+    // manager's own settings are left alone.
+    void setDeviceFilter(InputDevice device, const InputFilterSettings& settings) {
+        const size_t idx = static_cast<size_t>(device);
+        if (idx >= m_deviceFilters.size())
+            return;
+        m_deviceFilters[idx] = settings;
+        m_useDeviceFilters = true;
+    }
+
+    ReplayReport run(const std::vector<InputRecord>& records, InputManager& input,
+                     const ReplayOptions& options = {}) const {
+        using Clock = std::chrono::steady_clock;
+        std::vector<double> ingest;
+        std::vector<double> predict;
+        std::vector<double> submit;
+        ingest.reserve(records.size());
+
+        ReplayReport report;
+        const double speed = options.speed > 0.0 ? options.speed : 1.0;
+        const auto start = Clock::now();
+        const uint64_t firstMs = records.empty() ? 0 : records.front().timestampMs;
+        size_t activeDevice = m_deviceFilters.size();
+        for (const InputRecord& record : records) {
+            if (options.realtime) {
+                const auto offset = std::chrono::duration<double, std::milli>(
+                    static_cast<double>(record.timestampMs - firstMs) / speed);
+                std::this_thread::sleep_until(
+                    start + std::chrono::duration_cast<Clock::duration>(offset));
+            }
+            ++report.events;
+            auto t0 = Clock::now();
+            bool kept = false;
+            bool ended = false;
+            if (record.type == InputRecord::Type::Tap) {
+                const size_t device = static_cast<size_t>(record.device);
+                if (m_useDeviceFilters && !input.capturing() && device != activeDevice &&
+                    device < m_deviceFilters.size()) {
+                    activeDevice = device;
+                    input.setFilterSettings(m_deviceFilters[device]);
+                }
+                const TapAction act = input.onTapSequence(record.timestampMs);
+                if (act == TapAction::StartSequence) {
+                    input.beginStroke();
+                    kept = input.addPoint(record.x, record.y, record.timestampMs);
+                } else if (act == TapAction::EndSequence) {
+                    ended = true;
+                } else if (act == TapAction::None && input.capturing()) {
+                    kept = input.addPoint(record.x, record.y, record.timestampMs);
+                }
+            } else if (input.capturing()) {
+                kept = input.addPoint(record.x, record.y, record.timestampMs);
+            }
+            ingest.push_back(elapsedMs(t0, Clock::now()));
+            if (kept) {
+                ++report.keptPoints;
+                if (m_predict) {
+                    t0 = Clock::now();
+                    m_predict(input);
+                    predict.push_back(elapsedMs(t0, Clock::now()));
+                }
+            }
+            if (ended) {
+                ++report.gestures;
+                if (m_submit) {
+                    t0 = Clock::now();
+                    m_submit(input);
+                    submit.push_back(elapsedMs(t0, Clock::now()));
+                }
+            }
+        }
+        report.wallMs = elapsedMs(start, Clock::now());
+        report.stages.push_back(summarize("ingest", ingest));
+        report.stages.push_back(summarize("predict", predict));
+        report.stages.push_back(summarize("submit", submit));
+        return report;
+    }
+
+private:
+    template <typename TimePoint>
+    static double elapsedMs(TimePoint from, TimePoint to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    static ReplayStageStats summarize(const char* name, std::vector<double>& samples) {
+        ReplayStageStats stats;
+        stats.name = name;
+        stats.count = samples.size();
+        if (samples.empty())
+            return stats;
+        std::sort(samples.begin(), samples.end());
+        for (double s : samples)
+            stats.totalMs += s;
+        auto at = [&](double p) {
+            const size_t idx = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+            return samples[std::min(idx, samples.size() - 1)];
+        };
+        stats.p50Ms = at(0.50);
+        stats.p95Ms = at(0.95);
+        stats.p99Ms = at(0.99);
+        stats.maxMs = samples.back();
+        return stats;
+    }
+
+    StageFn m_predict;
+    StageFn m_submit;
+    std::array<InputFilterSettings, 4> m_deviceFilters{}; // by InputDevice
+    bool m_useDeviceFilters{false};
+};
+
+} // namespace sc
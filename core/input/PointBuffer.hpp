@@ -0,0 +1,273 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "utils/Span.hpp"
+
+namespace sc {
+
+// Simple 2D point
+struct Point {
+    float x;
+    float y;
+};
+
+// Read-only view of points whose x and y values sit `stride` floats apart.
+// It binds to a std::vector<Point> (stride 2) as well as to the x and y
+// columns of a PointBuffer (stride 1), so recognizers take a PointView and
+// read either without copying. Elements are returned by value.
+class PointView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Point;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Point*;
+        using reference = Point;
+
+        Iterator(const PointView* view, size_t index) : m_view(view), m_index(index) {}
+        Point operator*() const { return (*m_view)[m_index]; }
+        Iterator& operator++() {
+            ++m_index;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator copy = *this;
+            ++m_index;
+            return copy;
+        }
+        bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const PointView* m_view;
+        size_t m_index;
+    };
+
+    PointView() = default;
+    PointView(const float* x, const float* y, size_t size, size_t stride = 1)
+        : m_x(x), m_y(y), m_size(size), m_stride(stride) {}
+    PointView(const Point* points, size_t size)
+        : m_x(size ? &points->x : nullptr), m_y(size ? &points->y : nullptr), m_size(size),
+          m_stride(sizeof(Point) / sizeof(float)) {}
+    PointView(const std::vector<Point>& points) : PointView(points.data(), points.size()) {}
+    // For braced point lists passed straight to a function; the list only
+    // lives until the end of the full expression.
+    PointView(std::initializer_list<Point> points) : PointView(points.begin(), points.size()) {}
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    float x(size_t i) const { return m_x[i * m_stride]; }
+    float y(size_t i) const { return m_y[i * m_stride]; }
+    Point operator[](size_t i) const { return {x(i), y(i)}; }
+    Point front() const { return (*this)[0]; }
+    Point back() const { return (*this)[m_size - 1]; }
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, m_size); }
+
+    // Points [offset, offset + count), clamped to the view.
+    PointView subview(size_t offset, size_t count = static_cast<size_t>(-1)) const {
+        offset = std::min(offset, m_size);
+        count = std::min(count, m_size - offset);
+        if (count == 0)
+            return PointView(nullptr, nullptr, 0, m_stride);
+        return PointView(m_x + offset * m_stride, m_y + offset * m_stride, count, m_stride);
+    }
+
+    std::vector<Point> toVector() const {
+        std::vector<Point> out;
+        out.reserve(m_size);
+        for (size_t i = 0; i < m_size; ++i)
+            out.push_back((*this)[i]);
+        return out;
+    }
+
+private:
+    static_assert(sizeof(Point) == 2 * sizeof(float), "Point must be two packed floats");
+
+    const float* m_x{nullptr};
+    const float* m_y{nullptr};
+    size_t m_size{0};
+    size_t m_stride{1};
+};
+
+// Captured points as struct-of-arrays columns: timestamp (ms), x, y,
+// pressure and stroke id. All five columns share one block: an inline one
+// for gestures of up to kInlineCapacity points, and a single heap block
+// (grown by doubling) beyond that. clear() keeps the block, so capture
+// reaches a steady state without allocating.
+//
+// Stroke ids are expected to be non-decreasing, which lets stroke() find a
+// stroke's points with a binary search.
+class PointBuffer {
+public:
+    static constexpr size_t kInlineCapacity = 64;
+
+    PointBuffer() = default;
+
+    PointBuffer(const PointBuffer& other) { *this = other; }
+
+    PointBuffer& operator=(const PointBuffer& other) {
+        if (this == &other)
+            return *this;
+        clear();
+        reserve(other.m_size);
+        copyColumns(other, 0, other.m_size);
+        m_size = other.m_size;
+        return *this;
+    }
+
+    PointBuffer(PointBuffer&& other) noexcept { *this = std::move(other); }
+
+    PointBuffer& operator=(PointBuffer&& other) noexcept {
+        if (this == &other)
+            return *this;
+        if (other.m_heap) {
+            m_heap = std::move(other.m_heap);
+            m_capacity = other.m_capacity;
+            m_size = other.m_size;
+        } else {
+            m_heap.reset();
+            m_capacity = kInlineCapacity;
+            copyColumns(other, 0, other.m_size);
+            m_size = other.m_size;
+        }
+        other.m_capacity = kInlineCapacity;
+        other.m_size = 0;
+        return *this;
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+    // True once the points no longer fit the inline block.
+    bool onHeap() const { return static_cast<bool>(m_heap); }
+
+    void clear() { m_size = 0; }
+
+    void reserve(size_t count) {
+        if (count <= m_capacity)
+            return;
+        size_t capacity = m_capacity;
+        while (capacity < count)
+            capacity *= 2;
+        std::unique_ptr<unsigned char[]> block(new unsigned char[capacity * kBytesPerPoint]);
+        PointBuffer grown;
+        grown.m_heap = std::move(block);
+        grown.m_capacity = capacity;
+        grown.copyColumns(*this, 0, m_size);
+        m_heap = std::move(grown.m_heap);
+        m_capacity = capacity;
+    }
+
+    void push_back(float x, float y, uint64_t timestampMs = 0, float pressure = 1.f,
+                   uint32_t strokeId = 0) {
+        if (m_size == m_capacity)
+            reserve(m_size + 1);
+        times()[m_size] = timestampMs;
+        xs()[m_size] = x;
+        ys()[m_size] = y;
+        pressures()[m_size] = pressure;
+        strokeIdsMutable()[m_size] = strokeId;
+        ++m_size;
+    }
+
+    // Copies point `from` over point `to` (all columns), for in-place
+    // compaction followed by truncate().
+    void copyPoint(size_t from, size_t to) {
+        times()[to] = times()[from];
+        xs()[to] = xs()[from];
+        ys()[to] = ys()[from];
+        pressures()[to] = pressures()[from];
+        strokeIdsMutable()[to] = strokeIdsMutable()[from];
+    }
+
+    void truncate(size_t count) { m_size = std::min(m_size, count); }
+
+    // Drops every other point in place, keeping the first and the last.
+    void halve() {
+        const size_t n = m_size;
+        if (n < 3)
+            return;
+        size_t out = 0;
+        for (size_t i = 0; i < n; i += 2)
+            copyPoint(i, out++);
+        if ((n - 1) % 2 != 0)
+            copyPoint(n - 1, out++);
+        truncate(out);
+    }
+
+    Point operator[](size_t i) const { return {x()[i], y()[i]}; }
+    Point back() const { return (*this)[m_size - 1]; }
+
+    Span<const uint64_t> timestamps() const { return {columns<uint64_t>(0), m_size}; }
+    Span<const float> x() const { return {columns<float>(kTimeBytes), m_size}; }
+    Span<const float> y() const { return {columns<float>(kTimeBytes + 4), m_size}; }
+    Span<const float> pressure() const { return {columns<float>(kTimeBytes + 8), m_size}; }
+    Span<const uint32_t> strokeIds() const { return {columns<uint32_t>(kTimeBytes + 12), m_size}; }
+
+    PointView view() const { return PointView(x().data(), y().data(), m_size); }
+
+    // Index range [first, second) of the points of stroke `id`.
+    std::pair<size_t, size_t> strokeRange(uint32_t id) const {
+        const Span<const uint32_t> ids = strokeIds();
+        const auto range = std::equal_range(ids.begin(), ids.end(), id);
+        return {static_cast<size_t>(range.first - ids.begin()),
+                static_cast<size_t>(range.second - ids.begin())};
+    }
+
+    PointView stroke(uint32_t id) const {
+        const auto range = strokeRange(id);
+        return view().subview(range.first, range.second - range.first);
+    }
+
+private:
+    // Column order within the block; the 8-byte column comes first so every
+    // column stays naturally aligned.
+    static constexpr size_t kTimeBytes = sizeof(uint64_t);
+    static constexpr size_t kBytesPerPoint = kTimeBytes + 3 * sizeof(float) + sizeof(uint32_t);
+
+    unsigned char* block() { return m_heap ? m_heap.get() : m_inline; }
+    const unsigned char* block() const { return m_heap ? m_heap.get() : m_inline; }
+
+    // A column of `capacity` elements starts at capacity * offsetPerPoint,
+    // where offsetPerPoint is the summed size of the columns before it.
+    template <typename T>
+    T* columns(size_t offsetPerPoint) {
+        return reinterpret_cast<T*>(block() + m_capacity * offsetPerPoint);
+    }
+    template <typename T>
+    const T* columns(size_t offsetPerPoint) const {
+        return reinterpret_cast<const T*>(block() + m_capacity * offsetPerPoint);
+    }
+
+    uint64_t* times() { return columns<uint64_t>(0); }
+    float* xs() { return columns<float>(kTimeBytes); }
+    float* ys() { return columns<float>(kTimeBytes + 4); }
+    float* pressures() { return columns<float>(kTimeBytes + 8); }
+    uint32_t* strokeIdsMutable() { return columns<uint32_t>(kTimeBytes + 12); }
+
+    void copyColumns(const PointBuffer& other, size_t first, size_t count) {
+        std::memcpy(times() + first, other.timestamps().data() + first, count * sizeof(uint64_t));
+        std::memcpy(xs() + first, other.x().data() + first, count * sizeof(float));
+        std::memcpy(ys() + first, other.y().data() + first, count * sizeof(float));
+        std::memcpy(pressures() + first, other.pressure().data() + first, count * sizeof(float));
+        std::memcpy(strokeIdsMutable() + first, other.strokeIds().data() + first,
+                    count * sizeof(uint32_t));
+    }
+
+    alignas(uint64_t) unsigned char m_inline[kInlineCapacity * kBytesPerPoint];
+    std::unique_ptr<unsigned char[]> m_heap;
+    size_t m_capacity{kInlineCapacity};
+    size_t m_size{0};
+};
+
+} // namespace sc
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sc {
+
+// Fixed-capacity lock-free queue for exactly one producer thread and one
+// consumer thread, e.g. the event thread feeding input points to a
+// recognition worker. Storage is allocated once, so pushing and popping
+// never allocate. A push into a full ring fails and is counted instead of
+// blocking the producer.
+//
+// The producer and consumer indices live on separate cache lines, each next
+// to a cached copy of the other side's index, so the two threads only touch
+// each other's line when the cached view says the ring looks full or empty.
+template <typename T>
+class SpscRing {
+public:
+    static constexpr size_t kCacheLine = 64;
+
+    // Capacity is rounded up to a power of two.
+    explicit SpscRing(size_t capacity = 1024) {
+        size_t rounded = 2;
+        while (rounded < capacity)
+            rounded <<= 1;
+        m_mask = rounded - 1;
+        m_slots.reset(new T[rounded]);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return m_mask + 1; }
+
+    // Producer side. Returns false and bumps overflowCount() unless more
+    // than `reserve` slots are free, so a producer can keep the last slots
+    // for items that must not be dropped.
+    bool tryPush(const T& value, size_t reserve = 0) {
+        const size_t tail = m_producer.index.load(std::memory_order_relaxed);
+        if (tail - m_producer.cachedOther + reserve > m_mask) {
+            m_producer.cachedOther = m_consumer.index.load(std::memory_order_acquire);
+            if (tail - m_producer.cachedOther + reserve > m_mask) {
+                m_producer.overflow.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = value;
+        m_producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool tryPop(T& out) {
+        const size_t head = m_consumer.index.load(std::memory_order_relaxed);
+        if (head == m_consumer.cachedOther) {
+            m_consumer.cachedOther = m_producer.index.load(std::memory_order_acquire);
+            if (head == m_consumer.cachedOther)
+                return false;
+        }
+        out = m_slots[head & m_mask];
+        m_consumer.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Hands up to `max` queued items to `fn` in order and
+    // releases their slots in one store. Returns the number consumed.
+    template <typename Fn>
+    size_t drain(Fn&& fn, size_t max = SIZE_MAX) {
+        const size_t head = m_consumer.index.load(std::memory_order_relaxed);
+        m_consumer.cachedOther = m_producer.index.load(std::memory_order_acquire);
+        size_t available = m_consumer.cachedOther - head;
+        if (available > max)
+            available = max;
+        for (size_t i = 0; i < available; ++i)
+            fn(m_slots[(head + i) & m_mask]);
+        if (available)
+            m_consumer.index.store(head + available, std::memory_order_release);
+        return available;
+    }
+
+    // Approximate when called while the other side is active. The consumer
+    // index is read first: it never passes the producer index, so a later
+    // read of the producer index cannot be smaller.
+    size_t size() const {
+        const size_t head = m_consumer.index.load(std::memory_order_acquire);
+        return m_producer.index.load(std::memory_order_acquire) - head;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Pushes rejected because the ring was full.
+    uint64_t overflowCount() const {
+        return m_producer.overflow.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(kCacheLine) Side {
+        std::atomic<size_t> index{0};
+        size_t cachedOther{0}; // last seen index of the opposite side
+        std::atomic<uint64_t> overflow{0}; // producer only
+    };
+
+    // Read-only after construction, so both threads can share this line.
+    size_t m_mask{0};
+    std::unique_ptr<T[]> m_slots;
+    Side m_producer;
+    Side m_consumer;
+};
+
+} // namespace sc
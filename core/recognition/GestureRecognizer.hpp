@@ -78,7 +78,7 @@ public:
         return true;
     }
 
-    void addSample(const std::string& label, const std::vector<Point>& pts,
+    void addSample(const std::string& label, PointView pts,
                    const std::string& command) {
         m_redo.clear();
         GestureSample s;
@@ -102,7 +102,7 @@ public:
         return true;
     }
 
-    std::string predict(const std::vector<Point>& pts) const {
+    std::string predict(PointView pts) const {
         if (m_samples.empty()) return std::string();
         std::vector<float> feat = toFeature(pts);
         float bestDist = std::numeric_limits<float>::max();
@@ -121,7 +121,7 @@ public:
         return bestLabel;
     }
 
-    std::pair<std::string, float> predictWithDistance(const std::vector<Point>& pts) const {
+    std::pair<std::string, float> predictWithDistance(PointView pts) const {
         if (m_samples.empty()) return {std::string(), std::numeric_limits<float>::max()};
         std::vector<float> feat = toFeature(pts);
         float bestDist = std::numeric_limits<float>::max();
@@ -146,7 +146,7 @@ public:
         return std::string();
     }
 
-    std::string commandForGesture(const std::vector<Point>& pts) const {
+    std::string commandForGesture(PointView pts) const {
         std::string lbl = predict(pts);
         return commandForLabel(lbl);
     }
@@ -154,7 +154,7 @@ public:
     bool empty() const { return m_samples.empty(); }
 
 private:
-    std::vector<float> toFeature(const std::vector<Point>& pts) const {
+    std::vector<float> toFeature(PointView pts) const {
         std::vector<float> feat;
         feat.reserve(m_maxPoints * 2);
         size_t n = std::min<size_t>(pts.size(), m_maxPoints);
@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "../input/InputManager.hpp"
+
+namespace sc {
+
+struct GlyphRasterOptions {
+    int size{384};            // output is size x size pixels
+    float margin{0.15f};      // fraction of the side left blank on each edge
+    float strokeWidth{2.4f};  // in input units; scaled with the glyph
+    float minStrokeWidth{1.5f}; // lower bound in output pixels
+};
+
+// Draws captured strokes straight into an ink-coverage buffer at model
+// resolution, without Qt. The strokes are fitted into the square (keeping
+// their aspect ratio) and every segment is drawn as an antialiased capsule:
+// coverage falls off linearly over one pixel at the capsule edge, and
+// overlapping segments take the maximum so joints do not darken. The buffer
+// is reused between calls.
+class GlyphRasterizer {
+public:
+    // Draws every stroke of a captured gesture, split by stroke id, reading
+    // the buffer's columns in place.
+    const std::vector<float>& rasterize(const PointBuffer& points,
+                                        const GlyphRasterOptions& options = {}) {
+        m_views.clear();
+        for (size_t i = 0; i < points.size();) {
+            const size_t end = points.strokeRange(points.strokeIds()[i]).second;
+            m_views.push_back(points.view().subview(i, end - i));
+            i = end;
+        }
+        return rasterize(m_views, options);
+    }
+
+    // Returns size*size coverage values in [0,1], row-major (1 = ink).
+    // `strokes` is a container of anything a PointView binds to, e.g.
+    // std::vector<std::vector<Point>>.
+    template <typename Strokes>
+    const std::vector<float>& rasterize(const Strokes& strokes,
+                                        const GlyphRasterOptions& options = {}) {
+        const int size = std::max(1, options.size);
+        m_size = size;
+        m_coverage.assign(static_cast<size_t>(size) * size, 0.f);
+
+        float minX = 0.f, maxX = 0.f, minY = 0.f, maxY = 0.f;
+        bool any = false;
+        for (const auto& entry : strokes) {
+            for (const Point p : PointView(entry)) {
+                if (!any) {
+                    minX = maxX = p.x;
+                    minY = maxY = p.y;
+                    any = true;
+                } else {
+                    minX = std::min(minX, p.x);
+                    maxX = std::max(maxX, p.x);
+                    minY = std::min(minY, p.y);
+                    maxY = std::max(maxY, p.y);
+                }
+            }
+        }
+        if (!any)
+            return m_coverage;
+
+        const float target = static_cast<float>(size) * (1.f - 2.f * options.margin);
+        const float extent = std::max(maxX - minX, maxY - minY);
+        // A single point or a zero-length stroke is drawn as a dot at scale 1.
+        const float scale = extent > 0.f ? target / extent : 1.f;
+        const float offX = 0.5f * static_cast<float>(size) - scale * 0.5f * (minX + maxX);
+        const float offY = 0.5f * static_cast<float>(size) - scale * 0.5f * (minY + maxY);
+        const float radius = 0.5f * std::max(options.minStrokeWidth, options.strokeWidth * scale);
+
+        for (const auto& entry : strokes) {
+            const PointView stroke(entry);
+            if (stroke.empty())
+                continue;
+            Point prev{stroke[0].x * scale + offX, stroke[0].y * scale + offY};
+            if (stroke.size() == 1)
+                drawCapsule(prev, prev, radius);
+            for (size_t i = 1; i < stroke.size(); ++i) {
+                Point cur{stroke[i].x * scale + offX, stroke[i].y * scale + offY};
+                drawCapsule(prev, cur, radius);
+                prev = cur;
+            }
+        }
+        return m_coverage;
+    }
+
+    int size() const { return m_size; }
+    const float* data() const { return m_coverage.data(); }
+
+private:
+    // Pixel centres sit at (x + 0.5, y + 0.5).
+    void drawCapsule(Point a, Point b, float radius) {
+        const float reach = radius + 0.5f;
+        const int x0 = std::max(0, static_cast<int>(std::floor(std::min(a.x, b.x) - reach)));
+        const int x1 = std::min(m_size - 1, static_cast<int>(std::ceil(std::max(a.x, b.x) + reach)));
+        const int y0 = std::max(0, static_cast<int>(std::floor(std::min(a.y, b.y) - reach)));
+        const int y1 = std::min(m_size - 1, static_cast<int>(std::ceil(std::max(a.y, b.y) + reach)));
+        if (x0 > x1 || y0 > y1)
+            return;
+        const float dx = b.x - a.x;
+        const float dy = b.y - a.y;
+        const float lenSq = dx * dx + dy * dy;
+        const float invLenSq = lenSq > 0.f ? 1.f / lenSq : 0.f;
+        const float reachSq = reach * reach;
+        for (int y = y0; y <= y1; ++y) {
+            const float py = static_cast<float>(y) + 0.5f - a.y;
+            float* row = m_coverage.data() + static_cast<size_t>(y) * m_size;
+            for (int x = x0; x <= x1; ++x) {
+                const float px = static_cast<float>(x) + 0.5f - a.x;
+                const float t = std::min(1.f, std::max(0.f, (px * dx + py * dy) * invLenSq));
+                const float ex = px - t * dx;
+                const float ey = py - t * dy;
+                const float distSq = ex * ex + ey * ey;
+                if (distSq >= reachSq)
+                    continue;
+                const float cover = std::min(1.f, reach - std::sqrt(distSq));
+                if (cover > row[x])
+                    row[x] = cover;
+            }
+        }
+    }
+
+    int m_size{0};
+    std::vector<float> m_coverage;
+    std::vector<PointView> m_views; // per-stroke views for the PointBuffer overload
+};
+
+} // namespace sc
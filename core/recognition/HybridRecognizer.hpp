@@ -16,12 +16,12 @@ public:
     bool loadCustomProfile(const std::string& path) { return m_custom.loadProfile(path); }
     bool saveCustomProfile(const std::string& path) const { return m_custom.saveProfile(path); }
 
-    void addCustomSample(const std::string& label, const std::vector<Point>& pts,
+    void addCustomSample(const std::string& label, PointView pts,
                          const std::string& command) {
         m_custom.addSample(label, pts, command);
     }
 
-    std::string predict(const std::vector<Point>& pts) const {
+    std::string predict(PointView pts) const {
         if (!m_custom.empty()) {
             auto res = m_custom.predictWithDistance(pts);
             if (!res.first.empty() && res.second < 0.5f)
@@ -37,7 +37,7 @@ public:
         return m_model.commandForSymbol(symbol);
     }
 
-    std::string commandForGesture(const std::vector<Point>& pts) const {
+    std::string commandForGesture(PointView pts) const {
         std::string sym = predict(pts);
         return commandForSymbol(sym);
     }
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "SimdKernels.hpp"
+
+namespace sc {
+
+// Byte order of a packed 8-bit, four channel pixel in memory.
+enum class PixelLayout {
+    Rgba, // QImage::Format_RGBA8888 / RGBX8888
+    Bgra, // QImage::Format_ARGB32 / RGB32 on little-endian hosts
+    Argb  // QImage::Format_ARGB32 / RGB32 on big-endian hosts
+};
+
+// Per-channel normalization applied as (value / 255 - mean) / std.
+struct ChannelNorm {
+    float mean[3];
+    float std[3];
+};
+
+// TrOCR's ViT image processor: scale to [0,1], then mean 0.5 / std 0.5.
+constexpr ChannelNorm kTrocrNorm{{0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}};
+
+// Converts packed scanlines to normalized planar RGB floats in one pass.
+// `out` receives three planes of width*height floats (CHW order, so it can
+// be a {1,3,H,W} tensor's storage); `stride` is the distance between rows
+// in bytes. Alpha is ignored.
+inline void packedToPlanar(const uint8_t* pixels, int width, int height, size_t stride,
+                           PixelLayout layout, const ChannelNorm& norm, float* out) {
+    if (width <= 0 || height <= 0)
+        return;
+    int rIdx = 0, gIdx = 1, bIdx = 2;
+    if (layout == PixelLayout::Bgra) {
+        rIdx = 2;
+        bIdx = 0;
+    } else if (layout == PixelLayout::Argb) {
+        rIdx = 1;
+        gIdx = 2;
+        bIdx = 3;
+    }
+    // Fold the divide by 255, the mean and the std into one multiply-add.
+    float scale[4];
+    float bias[4];
+    const int channelOf[3] = {rIdx, gIdx, bIdx};
+    float* planes[4] = {nullptr, nullptr, nullptr, nullptr};
+    const size_t planeSize = static_cast<size_t>(width) * static_cast<size_t>(height);
+    for (int c = 0; c < 3; ++c) {
+        const int byte = channelOf[c];
+        scale[byte] = 1.f / (255.f * norm.std[c]);
+        bias[byte] = -norm.mean[c] / norm.std[c];
+        planes[byte] = out + static_cast<size_t>(c) * planeSize;
+    }
+    const int alpha = 6 - rIdx - gIdx - bIdx;
+    scale[alpha] = 0.f;
+    bias[alpha] = 0.f;
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(width);
+        float* dst[4];
+        for (int b = 0; b < 4; ++b)
+            dst[b] = planes[b] ? planes[b] + offset : nullptr;
+        int x = 0;
+#if defined(SC_SIMD_SSE2)
+        const __m128i mask = _mm_set1_epi32(0xff);
+        __m128 s[4], o[4];
+        for (int b = 0; b < 4; ++b) {
+            s[b] = _mm_set1_ps(scale[b]);
+            o[b] = _mm_set1_ps(bias[b]);
+        }
+        for (; x + 4 <= width; x += 4) {
+            const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 4 * x));
+            const __m128i lanes[4] = {_mm_and_si128(px, mask),
+                                      _mm_and_si128(_mm_srli_epi32(px, 8), mask),
+                                      _mm_and_si128(_mm_srli_epi32(px, 16), mask),
+                                      _mm_srli_epi32(px, 24)};
+            for (int b = 0; b < 4; ++b) {
+                if (!dst[b])
+                    continue;
+                __m128 v = _mm_cvtepi32_ps(lanes[b]);
+                _mm_storeu_ps(dst[b] + x, _mm_add_ps(_mm_mul_ps(v, s[b]), o[b]));
+            }
+        }
+#elif defined(SC_SIMD_NEON)
+        for (; x + 8 <= width; x += 8) {
+            const uint8x8x4_t px = vld4_u8(row + 4 * x);
+            for (int b = 0; b < 4; ++b) {
+                if (!dst[b])
+                    continue;
+                const uint16x8_t wide = vmovl_u8(px.val[b]);
+                const float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+                const float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(wide)));
+                const float32x4_t s = vdupq_n_f32(scale[b]);
+                const float32x4_t o = vdupq_n_f32(bias[b]);
+                vst1q_f32(dst[b] + x, vmlaq_f32(o, lo, s));
+                vst1q_f32(dst[b] + x + 4, vmlaq_f32(o, hi, s));
+            }
+        }
+#endif
+        for (; x < width; ++x) {
+            const uint8_t* px = row + 4 * x;
+            for (int b = 0; b < 4; ++b) {
+                if (dst[b])
+                    dst[b][x] = static_cast<float>(px[b]) * scale[b] + bias[b];
+            }
+        }
+    }
+}
+
+// Converts an ink-coverage buffer (0 = paper, 1 = ink, as produced by
+// GlyphRasterizer) to normalized planar RGB: black ink on white, the same
+// value in all three planes.
+inline void coverageToPlanar(const float* coverage, int width, int height,
+                             const ChannelNorm& norm, float* out) {
+    if (width <= 0 || height <= 0)
+        return;
+    const size_t planeSize = static_cast<size_t>(width) * static_cast<size_t>(height);
+    for (int c = 0; c < 3; ++c) {
+        // (1 - coverage - mean) / std as a single multiply-add.
+        const float scale = -1.f / norm.std[c];
+        const float bias = (1.f - norm.mean[c]) / norm.std[c];
+        float* plane = out + static_cast<size_t>(c) * planeSize;
+        for (size_t i = 0; i < planeSize; ++i)
+            plane[i] = coverage[i] * scale + bias;
+    }
+}
+
+} // namespace sc
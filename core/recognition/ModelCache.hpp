@@ -0,0 +1,181 @@
+#pragma once
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "NativeModel.hpp"
+#include "OrtEnvironment.hpp"
+#include "utils/Logger.hpp"
+#include "utils/MappedFile.hpp"
+
+namespace sc {
+
+// A model file loaded once and shared by every ModelRunner pointing at it.
+struct LoadedModel {
+    enum class Format { Native, Onnx, Unsupported };
+
+    std::string path;
+    Format format{Format::Unsupported};
+    size_t fileBytes{0};
+    // Growth of the process resident set while the model was loaded. This is
+    // the only measure available for memory owned inside ONNX Runtime.
+    size_t loadResidentBytes{0};
+    // Native weights reference this mapping directly; ONNX models drop it
+    // once the session has been built.
+    std::shared_ptr<const MappedFile> mapping;
+    std::shared_ptr<const NativeModel> native;
+#ifdef SC_USE_ONNXRUNTIME
+    std::shared_ptr<Ort::Session> session;
+    std::string inputName;
+    std::string outputName;
+#endif
+};
+
+enum class ModelLoadStatus { Ok, Missing, Malformed };
+
+// Memory attributed to one loaded model file.
+struct ModelMemoryUsage {
+    std::string path;
+    size_t fileBytes{0};
+    // Pages of the mapped file currently in RAM for native models, or the
+    // resident growth measured at load time for ONNX Runtime sessions.
+    size_t residentBytes{0};
+    // Heap copies made while loading (scaler inverses, unaligned arrays).
+    size_t privateBytes{0};
+    // Number of runners currently sharing this model.
+    long sharedBy{0};
+};
+
+inline ModelMemoryUsage memoryUsage(const std::shared_ptr<const LoadedModel>& model) {
+    ModelMemoryUsage usage;
+    if (!model)
+        return usage;
+    usage.path = model->path;
+    usage.fileBytes = model->fileBytes;
+    usage.sharedBy = model.use_count();
+    if (model->native) {
+        usage.privateBytes = model->native->ownedBytes();
+        usage.residentBytes = (model->mapping ? model->mapping->residentBytes() : 0) + usage.privateBytes;
+    } else {
+        usage.residentBytes = model->loadResidentBytes;
+    }
+    return usage;
+}
+
+// Process-wide registry of loaded models keyed by canonical path. Entries
+// are held weakly: a model is unloaded when its last runner lets go of it.
+class ModelCache {
+public:
+    static ModelCache& instance() {
+        static ModelCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const LoadedModel> acquire(const std::string& path, ModelLoadStatus& status) {
+        const std::string key = canonicalPath(path);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            if (auto existing = it->second.lock()) {
+                status = ModelLoadStatus::Ok;
+                return existing;
+            }
+        }
+        auto loaded = load(path, status);
+        for (auto e = m_entries.begin(); e != m_entries.end();) {
+            if (e->second.expired())
+                e = m_entries.erase(e);
+            else
+                ++e;
+        }
+        if (loaded)
+            m_entries[key] = loaded;
+        return loaded;
+    }
+
+    // Number of distinct model files currently loaded.
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t live = 0;
+        for (const auto& kv : m_entries)
+            live += !kv.second.expired();
+        return live;
+    }
+
+private:
+    ModelCache() = default;
+
+    static std::string canonicalPath(const std::string& path) {
+#ifdef _WIN32
+        char* resolved = _fullpath(nullptr, path.c_str(), 0);
+#else
+        char* resolved = realpath(path.c_str(), nullptr);
+#endif
+        if (!resolved)
+            return path;
+        std::string result(resolved);
+        std::free(resolved);
+        return result;
+    }
+
+    static std::shared_ptr<const LoadedModel> load(const std::string& path, ModelLoadStatus& status) {
+        const size_t residentBefore = processResidentBytes();
+        auto mapping = std::make_shared<const MappedFile>(path);
+        if (!mapping->opened()) {
+            status = ModelLoadStatus::Missing;
+            return nullptr;
+        }
+        status = ModelLoadStatus::Malformed;
+        if (!mapping->valid())
+            return nullptr;
+
+        auto model = std::make_shared<LoadedModel>();
+        model->path = path;
+        model->fileBytes = mapping->size();
+
+        // Compact models exported with --native_model run without ONNX Runtime.
+        if (NativeModel::hasMagic(mapping->data(), mapping->size())) {
+            auto native = std::make_shared<NativeModel>();
+            if (!native->loadFromMemory(mapping->data(), mapping->size(), mapping)) {
+                SC_LOG(sc::LogLevel::Error, "Native model " + path + " is malformed.");
+                return nullptr;
+            }
+            model->format = LoadedModel::Format::Native;
+            model->native = std::move(native);
+            model->mapping = std::move(mapping);
+            status = ModelLoadStatus::Ok;
+            return model;
+        }
+
+#ifdef SC_USE_ONNXRUNTIME
+        Ort::SessionOptions opts = ortSessionOptions();
+        try {
+            model->session = std::make_shared<Ort::Session>(ortEnv(), mapping->data(), mapping->size(),
+                                                            opts, ortPrepackedWeights());
+            Ort::AllocatorWithDefaultOptions allocator;
+            model->inputName = model->session->GetInputNameAllocated(0, allocator).get();
+            model->outputName = model->session->GetOutputNameAllocated(0, allocator).get();
+        } catch (const Ort::Exception& e) {
+            SC_LOG(sc::LogLevel::Error, "ONNX Runtime could not load " + path + ": " + e.what());
+            return nullptr;
+        } catch (...) {
+            SC_LOG(sc::LogLevel::Error, "ONNX Runtime could not load " + path);
+            return nullptr;
+        }
+        model->format = LoadedModel::Format::Onnx;
+        mapping.reset();
+        const size_t residentAfter = processResidentBytes();
+        model->loadResidentBytes = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+#else
+        (void)residentBefore;
+#endif
+        status = ModelLoadStatus::Ok;
+        return model;
+    }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::weak_ptr<const LoadedModel>> m_entries;
+};
+
+} // namespace sc
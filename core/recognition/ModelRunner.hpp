@@ -7,7 +7,11 @@
 #include <cctype>
 #include <algorithm>
 #include <cmath>
+#include <memory>
 #include "../input/InputManager.hpp"
+#include "ModelCache.hpp"
+#include "NativeModel.hpp"
+#include "ShapeDescriptors.hpp"
 #include "utils/Logger.hpp"
 #ifdef SC_USE_ONNXRUNTIME
 #  include <onnxruntime_cxx_api.h>
@@ -24,41 +28,45 @@ public:
         loadCommands(commandFile);
     }
 
+    // Models are memory-mapped and shared through ModelCache: runners
+    // pointing at the same file (e.g. several router keys) reuse one set of
+    // weights and, with ONNX Runtime, one session.
     bool loadModel(const std::string& path) {
         m_modelPath = path;
         m_modelLoaded = false;
         m_warnedFallback = false;
         m_modelFilePresent = false;
-
-        // Ensure the model file actually exists before proceeding. Without
-        // ONNX Runtime enabled the function previously returned `true`
-        // unconditionally, which meant callers had no way of detecting a
-        // missing model and CI tests expecting a failure would pass
-        // incorrectly.
-        std::ifstream file(path, std::ios::binary);
-        if (!file.good())
+        m_loaded.reset();
+        m_native.reset();
+
+        // A missing model must be reported: callers and CI tests rely on a
+        // failure here rather than a silent heuristic fallback.
+        ModelLoadStatus status = ModelLoadStatus::Missing;
+        auto loaded = ModelCache::instance().acquire(path, status);
+        if (status == ModelLoadStatus::Missing)
             return false;
         m_modelFilePresent = true;
-
-#ifdef SC_USE_ONNXRUNTIME
-        session.reset();
-        Ort::SessionOptions opts;
-        opts.SetIntraOpNumThreads(1);
-        try {
-            session.emplace(env, path.c_str(), opts);
-            m_modelLoaded = true;
-        } catch (...) {
+        if (!loaded)
             return false;
-        }
-#endif
+        m_loaded = std::move(loaded);
+        m_native = m_loaded->native;
+        m_modelLoaded = m_loaded->format != LoadedModel::Format::Unsupported;
         return true;
     }
 
     // Returns the predicted symbol name.
-    std::string run(const std::vector<Point>& points) const {
+    std::string run(PointView points) const {
+        return run(points, nullptr);
+    }
+
+    // Same as run() but reuses descriptors the caller already computed for
+    // `points` when the heuristic fallback is taken.
+    std::string run(PointView points, const ShapeDescriptors* descriptors) const {
         if (points.empty()) return "";
+        if (m_native)
+            return m_native->predict(points);
 #ifdef SC_USE_ONNXRUNTIME
-        if (session) {
+        if (m_loaded && m_loaded->session) {
             std::vector<float> input;
             for (const auto& p : points) {
                 input.push_back(p.x);
@@ -69,10 +77,9 @@ public:
             std::array<int64_t, 2> shape{1, 6};
             Ort::MemoryInfo mem = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
             Ort::Value tensor = Ort::Value::CreateTensor<float>(mem, input.data(), input.size(), shape.data(), 2);
-            Ort::AllocatorWithDefaultOptions allocator;
-            auto inputName = session->GetInputNameAllocated(0, allocator);
-            auto outputName = session->GetOutputNameAllocated(0, allocator);
-            auto outputTensors = session->Run(Ort::RunOptions{nullptr}, &inputName.get(), &tensor, 1, &outputName.get(), 1);
+            const char* inputName = m_loaded->inputName.c_str();
+            const char* outputName = m_loaded->outputName.c_str();
+            auto outputTensors = m_loaded->session->Run(Ort::RunOptions{nullptr}, &inputName, &tensor, 1, &outputName, 1);
             auto& out = outputTensors.front();
             int64_t idx = out.GetTensorMutableData<int64_t>()[0];
             switch (idx) {
@@ -98,9 +105,23 @@ public:
                            " not available. Falling back to heuristic detection.");
             m_warnedFallback = true;
         }
+        if (descriptors)
+            return classifyShape(*descriptors);
         return classifyHeuristic(points);
     }
 
+    // Heuristic classifier used when no model is available. Scratch space for
+    // the hull comes from the caller; the per-thread overload below keeps a
+    // buffer that only grows.
+    static std::string classifyHeuristic(PointView points, ShapeScratch& scratch) {
+        return classifyShape(describeShape(points, scratch));
+    }
+
+    static std::string classifyHeuristic(PointView points) {
+        thread_local ShapeScratch scratch;
+        return classifyHeuristic(points, scratch);
+    }
+
     std::string commandForSymbol(const std::string& symbol) const {
         auto it = m_commands.find(symbol);
         if (it != m_commands.end())
@@ -110,6 +131,11 @@ public:
 
     const std::string& modelPath() const { return m_modelPath; }
 
+    // True when the loaded model runs on the built-in native engine.
+    bool usesNativeModel() const { return static_cast<bool>(m_native); }
+
+    ModelMemoryUsage memoryUsage() const { return sc::memoryUsage(m_loaded); }
+
 private:
     void loadCommands(const std::string& path) {
         m_commands = {
@@ -194,115 +220,18 @@ private:
         }
     }
 
-    std::string classifyHeuristic(const std::vector<Point>& points) const {
-        if (points.empty())
-            return std::string();
-
-        if (points.size() <= 2)
-            return "circle";
-
-        float minX = points.front().x;
-        float maxX = points.front().x;
-        float minY = points.front().y;
-        float maxY = points.front().y;
-        float sumX = 0.f;
-        float sumY = 0.f;
-        for (const auto& p : points) {
-            minX = std::min(minX, p.x);
-            maxX = std::max(maxX, p.x);
-            minY = std::min(minY, p.y);
-            maxY = std::max(maxY, p.y);
-            sumX += p.x;
-            sumY += p.y;
-        }
-
-        const float width = std::max(1e-3f, maxX - minX);
-        const float height = std::max(1e-3f, maxY - minY);
-        const float aspect = width > height ? width / height : height / width;
-        const float cx = sumX / static_cast<float>(points.size());
-        const float cy = sumY / static_cast<float>(points.size());
-
-        float meanRadius = 0.f;
-        std::vector<float> radii;
-        radii.reserve(points.size());
-        for (const auto& p : points) {
-            float dx = p.x - cx;
-            float dy = p.y - cy;
-            float dist = std::sqrt(dx * dx + dy * dy);
-            radii.push_back(dist);
-            meanRadius += dist;
-        }
-        meanRadius /= static_cast<float>(radii.size());
-
-        float variance = 0.f;
-        for (float r : radii) {
-            float diff = r - meanRadius;
-            variance += diff * diff;
-        }
-        variance /= static_cast<float>(std::max<size_t>(1, radii.size() - 1));
-        float radiusStdDev = std::sqrt(variance);
-        float radialUniformity = meanRadius > 1e-3f ? radiusStdDev / meanRadius : 1.f;
-
-        auto cross = [](const Point& o, const Point& a, const Point& b) {
-            return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
-        };
-
-        std::vector<Point> sorted = points;
-        std::sort(sorted.begin(), sorted.end(), [](const Point& a, const Point& b) {
-            if (a.x == b.x)
-                return a.y < b.y;
-            return a.x < b.x;
-        });
-        sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const Point& a, const Point& b) {
-                         return std::fabs(a.x - b.x) < 1e-3f && std::fabs(a.y - b.y) < 1e-3f;
-                     }),
-                     sorted.end());
-
-        size_t hullSize = sorted.size();
-        if (sorted.size() >= 3) {
-            std::vector<Point> hull(2 * sorted.size());
-            size_t k = 0;
-            for (const auto& pt : sorted) {
-                while (k >= 2 && cross(hull[k - 2], hull[k - 1], pt) <= 0.f)
-                    --k;
-                hull[k++] = pt;
-            }
-            for (int i = static_cast<int>(sorted.size()) - 2, t = static_cast<int>(k) + 1; i >= 0; --i) {
-                const auto& pt = sorted[static_cast<size_t>(i)];
-                while (k >= static_cast<size_t>(t) && cross(hull[k - 2], hull[k - 1], pt) <= 0.f)
-                    --k;
-                hull[k++] = pt;
-            }
-            hullSize = k > 1 ? k - 1 : k;
-        }
-
-        if (hullSize >= 4 && aspect < 1.3f)
-            return "square";
-        if (hullSize == 3)
-            return "triangle";
-        if (radialUniformity < 0.25f)
-            return "circle";
-        if (aspect < 1.2f && points.size() > 12)
-            return "square";
-        if (points.size() > 10)
-            return "triangle";
-        return "circle";
-    }
-
     std::string m_modelPath;
     bool m_modelLoaded{false};
     bool m_modelFilePresent{false};
     mutable bool m_warnedFallback{false};
+    std::shared_ptr<const LoadedModel> m_loaded;
+    std::shared_ptr<const NativeModel> m_native;
 #ifdef SC_USE_ONNXRUNTIME
     bool m_runtimeEnabled{true};
 #else
     bool m_runtimeEnabled{false};
 #endif
     std::unordered_map<std::string, std::string> m_commands;
-#ifdef SC_USE_ONNXRUNTIME
-    Ort::Env env{ORT_LOGGING_LEVEL_WARNING, "symbolcast"};
-    std::optional<Ort::Session> session;
-#endif
 };
 
 } // namespace sc
@@ -0,0 +1,187 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../input/InputManager.hpp"
+#include "utils/Logger.hpp"
+
+namespace sc {
+
+// Cold (first call) and warm (steady state) latency of one warm-up task.
+struct WarmupTiming {
+    std::string name;
+    double coldMs{0.0};
+    double warmMs{0.0};
+    bool ok{true};
+};
+
+// Synthetic closed stroke used to exercise recognizers before the first
+// real gesture arrives.
+inline std::vector<Point> makeWarmupGesture(size_t count = 32) {
+    std::vector<Point> pts;
+    pts.reserve(count);
+    const float twoPi = 6.2831853f;
+    for (size_t i = 0; i < count; ++i) {
+        float a = twoPi * static_cast<float>(i) / static_cast<float>(count);
+        pts.push_back({100.f + 40.f * std::cos(a), 100.f + 40.f * std::sin(a)});
+    }
+    return pts;
+}
+
+// Runs registered tasks once cold and a few times warm on a background
+// thread so lazy model loading and first-inference costs are paid at
+// startup instead of on the user's first gesture. Callers that depend on
+// the warmed models wait on ready()/wait() before using them, or register
+// setOnReady() to be told without blocking.
+class ModelWarmup {
+public:
+    using Task = std::function<bool()>;
+
+    explicit ModelWarmup(int warmIterations = 3, double budgetMs = 250.0)
+        : m_warmIterations(warmIterations > 0 ? warmIterations : 1), m_budgetMs(budgetMs) {}
+
+    ~ModelWarmup() {
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    ModelWarmup(const ModelWarmup&) = delete;
+    ModelWarmup& operator=(const ModelWarmup&) = delete;
+
+    // Tasks must be registered before start().
+    void add(std::string name, Task task) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_started)
+            return;
+        m_tasks.push_back({std::move(name), std::move(task)});
+    }
+
+    // Called on the warm-up thread once ready() turns true. Must be set
+    // before start().
+    void setOnReady(std::function<void()> fn) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_started)
+            return;
+        m_onReady = std::move(fn);
+    }
+
+    void setBudgetMs(double budgetMs) { m_budgetMs = budgetMs; }
+    double budgetMs() const { return m_budgetMs; }
+
+    void start() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_started)
+                return;
+            m_started = true;
+        }
+        m_thread = std::thread([this] { runAll(); });
+    }
+
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_ready;
+    }
+
+    void wait() const {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_ready || !m_started; });
+    }
+
+    bool waitFor(std::chrono::milliseconds timeout) const {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cv.wait_for(lock, timeout, [this] { return m_ready || !m_started; }) && m_ready;
+    }
+
+    std::vector<WarmupTiming> report() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_report;
+    }
+
+    double totalMs() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_totalMs;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        Task task;
+    };
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+    void runAll() {
+        std::vector<Entry> tasks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            tasks = m_tasks;
+        }
+        std::vector<WarmupTiming> report;
+        report.reserve(tasks.size());
+        const auto begin = std::chrono::steady_clock::now();
+        for (const auto& entry : tasks) {
+            WarmupTiming timing;
+            timing.name = entry.name;
+            auto start = std::chrono::steady_clock::now();
+            timing.ok = entry.task();
+            timing.coldMs = elapsedMs(start);
+            if (timing.ok) {
+                start = std::chrono::steady_clock::now();
+                for (int i = 0; i < m_warmIterations; ++i)
+                    entry.task();
+                timing.warmMs = elapsedMs(start) / m_warmIterations;
+            }
+            report.push_back(timing);
+        }
+        const double total = elapsedMs(begin);
+
+        for (const auto& t : report) {
+            std::ostringstream msg;
+            msg << std::fixed << std::setprecision(2) << "Warm-up " << t.name << ": cold "
+                << t.coldMs << " ms, warm " << t.warmMs << " ms" << (t.ok ? "" : " (failed)");
+            SC_LOG(sc::LogLevel::Info, msg.str());
+        }
+        if (m_budgetMs > 0.0 && total > m_budgetMs) {
+            std::ostringstream msg;
+            msg << std::fixed << std::setprecision(2) << "Recognition warm-up took " << total
+                << " ms, over the " << m_budgetMs << " ms startup budget";
+            SC_LOG(sc::LogLevel::Warn, msg.str());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_report = std::move(report);
+            m_totalMs = total;
+            m_ready = true;
+        }
+        m_cv.notify_all();
+        if (m_onReady)
+            m_onReady();
+    }
+
+    int m_warmIterations;
+    double m_budgetMs;
+    std::vector<Entry> m_tasks;
+    std::function<void()> m_onReady;
+    std::vector<WarmupTiming> m_report;
+    double m_totalMs{0.0};
+    bool m_started{false};
+    bool m_ready{false};
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cv;
+};
+
+} // namespace sc
@@ -0,0 +1,357 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../input/InputManager.hpp"
+#include "SimdKernels.hpp"
+
+namespace sc {
+
+// Dependency-free runtime for the compact models written by
+// scripts/training/train_symbol_model.py (--native_model). A model is a
+// StandardScaler followed by either a k-nearest-neighbour table or a small
+// ReLU MLP, stored little-endian as:
+//
+//   "SCNM" u32 version u32 kind(0=knn,1=mlp) u32 dim
+//   f32 mean[dim] f32 scale[dim]
+//   u32 labelCount { u32 len, bytes }[labelCount]
+//   version 2: zero padding up to the next 4-byte offset
+//   knn: u32 k u32 refCount f32 refs[refCount*dim] u32 refLabel[refCount]
+//   mlp: u32 layerCount { u32 in u32 out f32 w[out*in] f32 b[out] }[layerCount]
+//
+// Features match the training script: the first dim/2 points as x,y pairs,
+// zero padded.
+//
+// When loaded from a buffer that outlives the model (a memory-mapped file,
+// see ModelCache), aligned weight arrays are used in place instead of being
+// copied, so every router entry sharing the file shares one set of pages.
+class NativeModel {
+public:
+    enum class Kind : uint32_t { Knn = 0, Mlp = 1 };
+
+    static bool hasMagic(const void* data, size_t size) {
+        return size >= 4 && std::memcmp(data, "SCNM", 4) == 0;
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return false;
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                std::istreambuf_iterator<char>());
+        return loadFromMemory(bytes.data(), bytes.size());
+    }
+
+    // Copies everything it needs out of `data`.
+    bool loadFromMemory(const void* data, size_t size) {
+        return loadFromMemory(data, size, nullptr);
+    }
+
+    // Keeps `backing` alive and references aligned weight arrays inside
+    // `data` directly. `backing` must own the bytes at `data`.
+    bool loadFromMemory(const void* data, size_t size, std::shared_ptr<const void> backing) {
+        *this = NativeModel();
+        Reader r{static_cast<const uint8_t*>(data), size, 0, backing != nullptr && littleEndianHost()};
+        if (!hasMagic(data, size))
+            return false;
+        r.pos = 4;
+        uint32_t version = 0;
+        uint32_t kind = 0;
+        uint32_t dim = 0;
+        if (!r.u32(version) || version < 1 || version > 2 || !r.u32(kind) || kind > 1 ||
+            !r.u32(dim) || dim == 0 || dim > 4096)
+            return false;
+        m_kind = static_cast<Kind>(kind);
+        m_dim = dim;
+        FloatArray scale;
+        if (!r.floats(m_mean, dim) || !r.floats(scale, dim))
+            return false;
+        m_invScale.resize(dim);
+        for (size_t i = 0; i < dim; ++i)
+            m_invScale[i] = scale[i] != 0.f ? 1.f / scale[i] : 1.f;
+
+        uint32_t labelCount = 0;
+        if (!r.u32(labelCount) || labelCount == 0)
+            return false;
+        for (uint32_t i = 0; i < labelCount; ++i) {
+            uint32_t len = 0;
+            if (!r.u32(len) || len > r.remaining())
+                return false;
+            m_labels.emplace_back(reinterpret_cast<const char*>(r.data + r.pos), len);
+            r.pos += len;
+        }
+        if (version >= 2) {
+            const size_t pad = (4 - r.pos % 4) % 4;
+            if (pad > r.remaining())
+                return false;
+            r.pos += pad;
+        }
+
+        if (m_kind == Kind::Knn) {
+            uint32_t k = 0;
+            uint32_t refCount = 0;
+            if (!r.u32(k) || k == 0 || k > kMaxNeighbours || !r.u32(refCount) || refCount == 0)
+                return false;
+            m_k = std::min<uint32_t>(k, refCount);
+            m_refCount = refCount;
+            if (!r.floats(m_refs, static_cast<size_t>(refCount) * dim))
+                return false;
+            m_refLabels.resize(refCount);
+            for (uint32_t i = 0; i < refCount; ++i) {
+                if (!r.u32(m_refLabels[i]) || m_refLabels[i] >= labelCount)
+                    return false;
+            }
+        } else {
+            uint32_t layerCount = 0;
+            if (!r.u32(layerCount) || layerCount == 0 || layerCount > 16)
+                return false;
+            uint32_t expectedIn = dim;
+            for (uint32_t l = 0; l < layerCount; ++l) {
+                Layer layer;
+                if (!r.u32(layer.in) || !r.u32(layer.out) || layer.in != expectedIn ||
+                    layer.out == 0 || layer.out > 4096)
+                    return false;
+                if (!r.floats(layer.weights, static_cast<size_t>(layer.in) * layer.out) ||
+                    !r.floats(layer.bias, layer.out))
+                    return false;
+                expectedIn = layer.out;
+                m_maxWidth = std::max<size_t>(m_maxWidth, layer.out);
+                m_layers.push_back(std::move(layer));
+            }
+            const uint32_t outputs = m_layers.back().out;
+            if (outputs != labelCount && !(outputs == 1 && labelCount == 2))
+                return false;
+        }
+        if (r.borrowed)
+            m_backing = std::move(backing);
+        m_loaded = true;
+        return true;
+    }
+
+    bool loaded() const { return m_loaded; }
+    Kind kind() const { return m_kind; }
+    size_t inputDim() const { return m_dim; }
+    const std::vector<std::string>& labels() const { return m_labels; }
+
+    // Approximate size of the weights in bytes.
+    size_t weightBytes() const {
+        size_t bytes = (m_mean.size() + m_invScale.size() + m_refs.size()) * sizeof(float) +
+                       m_refLabels.size() * sizeof(uint32_t);
+        for (const auto& layer : m_layers)
+            bytes += (layer.weights.size() + layer.bias.size()) * sizeof(float);
+        return bytes;
+    }
+
+    // Part of weightBytes() held in private heap copies rather than
+    // referenced from the backing buffer.
+    size_t ownedBytes() const {
+        size_t bytes = m_mean.ownedBytes() + m_refs.ownedBytes() +
+                       m_invScale.size() * sizeof(float) + m_refLabels.size() * sizeof(uint32_t);
+        for (const auto& layer : m_layers)
+            bytes += layer.weights.ownedBytes() + layer.bias.ownedBytes();
+        return bytes;
+    }
+
+    std::string predict(PointView points) const {
+        int idx = predictIndex(points);
+        return idx < 0 ? std::string() : m_labels[static_cast<size_t>(idx)];
+    }
+
+    int predictIndex(PointView points) const {
+        if (!m_loaded)
+            return -1;
+        thread_local std::vector<float> features;
+        features.assign(m_dim, 0.f);
+        const size_t n = std::min(points.size(), m_dim / 2);
+        for (size_t i = 0; i < n; ++i) {
+            features[2 * i] = points[i].x;
+            features[2 * i + 1] = points[i].y;
+        }
+        return predictIndex(features.data());
+    }
+
+    // `features` holds inputDim() raw (unscaled) values.
+    int predictIndex(const float* features) const {
+        if (!m_loaded)
+            return -1;
+        thread_local std::vector<float> scratch;
+        const size_t width = std::max(m_dim, m_maxWidth);
+        if (scratch.size() < 2 * width)
+            scratch.resize(2 * width);
+        float* scaled = scratch.data();
+        simd::affine(features, m_mean.data(), m_invScale.data(), scaled, m_dim);
+        if (m_kind == Kind::Knn)
+            return nearestNeighbours(scaled);
+        return forward(scaled, scratch.data() + width);
+    }
+
+private:
+    static constexpr uint32_t kMaxNeighbours = 32;
+
+    // A float array that either points into the backing buffer or owns a
+    // copy. Copies rebind to their own storage.
+    class FloatArray {
+    public:
+        FloatArray() = default;
+        FloatArray(const FloatArray& other)
+            : m_ptr(other.m_ptr), m_size(other.m_size), m_owned(other.m_owned) {
+            if (!m_owned.empty())
+                m_ptr = m_owned.data();
+        }
+        FloatArray(FloatArray&&) noexcept = default;
+        FloatArray& operator=(FloatArray other) noexcept {
+            m_ptr = other.m_ptr;
+            m_size = other.m_size;
+            m_owned = std::move(other.m_owned);
+            return *this;
+        }
+
+        void borrow(const float* ptr, size_t size) {
+            m_owned.clear();
+            m_ptr = ptr;
+            m_size = size;
+        }
+        float* own(size_t size) {
+            m_owned.resize(size);
+            m_ptr = m_owned.data();
+            m_size = size;
+            return m_owned.data();
+        }
+
+        const float* data() const { return m_ptr; }
+        size_t size() const { return m_size; }
+        size_t ownedBytes() const { return m_owned.size() * sizeof(float); }
+        float operator[](size_t i) const { return m_ptr[i]; }
+
+    private:
+        const float* m_ptr{nullptr};
+        size_t m_size{0};
+        std::vector<float> m_owned;
+    };
+
+    struct Layer {
+        uint32_t in{0};
+        uint32_t out{0};
+        FloatArray weights; // out rows of `in` weights
+        FloatArray bias;
+    };
+
+    static bool littleEndianHost() {
+        const uint32_t probe = 1;
+        uint8_t first = 0;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    struct Reader {
+        const uint8_t* data;
+        size_t size;
+        size_t pos;
+        bool borrow;
+        bool borrowed{false};
+
+        size_t remaining() const { return size - pos; }
+
+        bool u32(uint32_t& v) {
+            if (remaining() < 4)
+                return false;
+            v = static_cast<uint32_t>(data[pos]) | (static_cast<uint32_t>(data[pos + 1]) << 8) |
+                (static_cast<uint32_t>(data[pos + 2]) << 16) |
+                (static_cast<uint32_t>(data[pos + 3]) << 24);
+            pos += 4;
+            return true;
+        }
+
+        bool floats(FloatArray& out, size_t count) {
+            if (count > remaining() / 4)
+                return false;
+            const uint8_t* src = data + pos;
+            if (borrow && reinterpret_cast<uintptr_t>(src) % alignof(float) == 0) {
+                out.borrow(reinterpret_cast<const float*>(src), count);
+                pos += count * 4;
+                borrowed = true;
+                return true;
+            }
+            float* dst = out.own(count);
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t bits = 0;
+                u32(bits);
+                std::memcpy(&dst[i], &bits, sizeof(float));
+            }
+            return true;
+        }
+    };
+
+    int nearestNeighbours(const float* query) const {
+        float bestDist[kMaxNeighbours];
+        uint32_t bestLabel[kMaxNeighbours];
+        uint32_t found = 0;
+        for (uint32_t r = 0; r < m_refCount; ++r) {
+            float dist = simd::squaredDistance(query, m_refs.data() + static_cast<size_t>(r) * m_dim,
+                                               m_dim);
+            if (found == m_k && dist >= bestDist[found - 1])
+                continue;
+            uint32_t pos = found < m_k ? found++ : found - 1;
+            while (pos > 0 && bestDist[pos - 1] > dist) {
+                bestDist[pos] = bestDist[pos - 1];
+                bestLabel[pos] = bestLabel[pos - 1];
+                --pos;
+            }
+            bestDist[pos] = dist;
+            bestLabel[pos] = m_refLabels[r];
+        }
+        // Majority vote; ties go to the label of the nearer neighbour.
+        int best = -1;
+        uint32_t bestVotes = 0;
+        for (uint32_t i = 0; i < found; ++i) {
+            uint32_t votes = 0;
+            for (uint32_t j = 0; j < found; ++j)
+                votes += bestLabel[j] == bestLabel[i];
+            if (votes > bestVotes) {
+                bestVotes = votes;
+                best = static_cast<int>(bestLabel[i]);
+            }
+        }
+        return best;
+    }
+
+    int forward(float* activations, float* next) const {
+        for (size_t l = 0; l < m_layers.size(); ++l) {
+            const Layer& layer = m_layers[l];
+            const bool hidden = l + 1 < m_layers.size();
+            for (uint32_t o = 0; o < layer.out; ++o) {
+                float v = simd::dot(layer.weights.data() + static_cast<size_t>(o) * layer.in,
+                                    activations, layer.in) +
+                          layer.bias[o];
+                next[o] = hidden ? std::max(0.f, v) : v;
+            }
+            std::swap(activations, next);
+        }
+        const uint32_t outputs = m_layers.back().out;
+        if (outputs == 1)
+            return activations[0] > 0.f ? 1 : 0;
+        return static_cast<int>(std::max_element(activations, activations + outputs) - activations);
+    }
+
+    bool m_loaded{false};
+    Kind m_kind{Kind::Knn};
+    size_t m_dim{0};
+    size_t m_maxWidth{0};
+    FloatArray m_mean;
+    std::vector<float> m_invScale;
+    std::vector<std::string> m_labels;
+    uint32_t m_k{1};
+    uint32_t m_refCount{0};
+    FloatArray m_refs;
+    std::vector<uint32_t> m_refLabels;
+    std::vector<Layer> m_layers;
+    std::shared_ptr<const void> m_backing;
+};
+
+} // namespace sc
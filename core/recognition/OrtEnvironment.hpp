@@ -0,0 +1,40 @@
+#pragma once
+#ifdef SC_USE_ONNXRUNTIME
+#  include <onnxruntime_cxx_api.h>
+
+namespace sc {
+
+// Process-wide ONNX Runtime state. Every session is created against the same
+// environment and prepacked weight container, so identical initializers
+// prepacked by one session are reused by the others instead of duplicated.
+//
+// The environment also owns the only intra-op and inter-op thread pools:
+// sessions built from ortSessionOptions() run on them instead of starting
+// their own, so gesture models and the TrOCR graphs share one set of workers.
+// Spinning is disabled because the pools are idle between strokes.
+inline Ort::Env& ortEnv() {
+    static Ort::Env env = [] {
+        Ort::ThreadingOptions threading;
+        threading.SetGlobalInterOpNumThreads(1);
+        threading.SetGlobalSpinControl(0);
+        return Ort::Env(threading, ORT_LOGGING_LEVEL_WARNING, "symbolcast");
+    }();
+    return env;
+}
+
+inline Ort::PrepackedWeightsContainer& ortPrepackedWeights() {
+    static Ort::PrepackedWeightsContainer container;
+    return container;
+}
+
+// Options for a session that runs on ortEnv()'s shared thread pools.
+inline Ort::SessionOptions ortSessionOptions() {
+    Ort::SessionOptions opts;
+    opts.DisablePerSessionThreads();
+    opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    return opts;
+}
+
+} // namespace sc
+
+#endif
@@ -1,7 +1,13 @@
 #pragma once
 #include "ModelRunner.hpp"
+#include "ModelWarmup.hpp"
+#include "ShadowEvaluator.hpp"
+#include <chrono>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <utility>
+#include <vector>
 #include <fstream>
 #include <cctype>
 
@@ -19,6 +25,7 @@ public:
         if (!in.is_open())
             return false;
         m_models.clear();
+        m_shadow.reset();
         std::string content((std::istreambuf_iterator<char>(in)),
                             std::istreambuf_iterator<char>());
         size_t pos = 0;
@@ -34,16 +41,21 @@ public:
             size_t endVal = content.find('"', pos + 1);
             if (endVal == std::string::npos) break;
             std::string val = content.substr(pos + 1, endVal - pos - 1);
-            m_models[key] = ModelRunner();
-            m_models[key].loadModel(val);
+            // "shadow:<key>" entries name a candidate evaluated next to <key>.
+            const std::string shadowPrefix = "shadow:";
+            if (key.compare(0, shadowPrefix.size(), shadowPrefix) == 0)
+                setShadowModel(key.substr(shadowPrefix.size()), val);
+            else
+                m_models[key].loadModel(val);
             pos = endVal + 1;
         }
         if (m_models.empty())
             loadFallbackModels();
+        logMemoryReport();
         return !m_models.empty();
     }
 
-    std::string recognize(const std::vector<Point>& pts, const std::string& mode = "auto") const {
+    std::string recognize(PointView pts, const std::string& mode = "auto") const {
         std::string chosen = mode;
         if (mode == "auto") {
             if (pts.size() <= 6)
@@ -51,10 +63,48 @@ public:
             else
                 chosen = "letter_model";
         }
-        auto it = m_models.find(chosen);
-        if (it == m_models.end())
-            return std::string();
-        return it->second.run(pts);
+        return route(pts, chosen, nullptr);
+    }
+
+    // Routes using descriptors the caller computed once for `pts` (see
+    // describeShape), so the heuristic fallback does not rescan the stroke.
+    std::string recognize(PointView pts, const ShapeDescriptors& desc,
+                          const std::string& mode = "auto") const {
+        std::string chosen = mode;
+        if (mode == "auto")
+            chosen = desc.pointCount <= 6 ? "shape_model" : "letter_model";
+        return route(pts, chosen, &desc);
+    }
+
+    // Runs `candidatePath` in shadow mode next to the model routed as
+    // `target`: every gesture recognized by `target` is also handed to the
+    // candidate on a background worker, and agreement, latency percentiles
+    // and disagreement samples are appended to `logPath`. Results returned by
+    // recognize() are unaffected.
+    bool setShadowModel(const std::string& target, const std::string& candidatePath,
+                        const std::string& logPath = "data/shadow_eval.jsonl") {
+        m_shadow.reset();
+        ModelRunner candidate;
+        if (!candidate.loadModel(candidatePath)) {
+            SC_LOG(sc::LogLevel::Warn, "Shadow model " + candidatePath + " could not be loaded");
+            return false;
+        }
+        m_shadow = std::make_unique<ShadowEvaluator>(target, std::move(candidate), logPath);
+        SC_LOG(sc::LogLevel::Info, "Shadowing " + target + " with " + candidatePath);
+        return true;
+    }
+
+    void clearShadowModel() { m_shadow.reset(); }
+
+    const ShadowEvaluator* shadow() const { return m_shadow.get(); }
+
+    // Memory attributed to each routed model. Keys configured with the same
+    // file share one mapping and report sharedBy > 1.
+    std::vector<std::pair<std::string, ModelMemoryUsage>> memoryReport() const {
+        std::vector<std::pair<std::string, ModelMemoryUsage>> report;
+        for (const auto& kv : m_models)
+            report.emplace_back(kv.first, kv.second.memoryUsage());
+        return report;
     }
 
     std::string commandForSymbol(const std::string& sym) const {
@@ -66,7 +116,50 @@ public:
         return std::string();
     }
 
+    // Registers one warm-up task per routed model. The runners must not be
+    // reloaded until the warm-up has finished.
+    void addWarmupTasks(ModelWarmup& warmup) const {
+        for (const auto& kv : m_models) {
+            const ModelRunner* runner = &kv.second;
+            warmup.add(kv.first, [runner] {
+                static const std::vector<Point> shortGesture = makeWarmupGesture(4);
+                static const std::vector<Point> longGesture = makeWarmupGesture(32);
+                runner->run(shortGesture);
+                return !runner->run(longGesture).empty();
+            });
+        }
+    }
+
 private:
+    std::string route(PointView pts, const std::string& chosen,
+                      const ShapeDescriptors* desc) const {
+        auto it = m_models.find(chosen);
+        if (it == m_models.end())
+            return std::string();
+        if (!m_shadow || m_shadow->target() != chosen)
+            return it->second.run(pts, desc);
+        auto start = std::chrono::steady_clock::now();
+        std::string label = it->second.run(pts, desc);
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        m_shadow->submit(pts, label, ms);
+        return label;
+    }
+
+    void logMemoryReport() const {
+        for (const auto& entry : memoryReport()) {
+            const ModelMemoryUsage& usage = entry.second;
+            if (usage.path.empty())
+                continue;
+            SC_LOG(sc::LogLevel::Info,
+                   "Model " + entry.first + " (" + usage.path + "): " +
+                       std::to_string(usage.residentBytes / 1024) + " KiB resident of " +
+                       std::to_string(usage.fileBytes / 1024) + " KiB, shared by " +
+                       std::to_string(usage.sharedBy));
+        }
+    }
+
     void loadFallbackModels() {
         if (!m_models.empty())
             return;
@@ -75,6 +168,7 @@ private:
     }
 
     std::unordered_map<std::string, ModelRunner> m_models;
+    std::unique_ptr<ShadowEvaluator> m_shadow;
 };
 
 } // namespace sc
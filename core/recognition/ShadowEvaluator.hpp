@@ -0,0 +1,269 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ModelRunner.hpp"
+#include "utils/Logger.hpp"
+
+namespace sc {
+
+struct ShadowStats {
+    size_t samples{0};
+    size_t agreements{0};
+    size_t dropped{0};
+    double agreementRate{0.0};
+    double primaryP50Ms{0.0};
+    double candidateP50Ms{0.0};
+    double candidateP95Ms{0.0};
+    double candidateP99Ms{0.0};
+};
+
+// Runs a candidate model next to a routed model on a background worker.
+// The primary result is never affected: gestures are queued (and dropped
+// when the queue is full), the candidate's label and latency are compared
+// off-thread, and disagreements plus a summary are appended as JSON lines
+// to a local file for offline review. The summary is written every
+// `summaryEvery` samples or `summaryInterval`, whichever comes first, and
+// again on shutdown, so a process that is killed still leaves recent
+// numbers behind.
+class ShadowEvaluator {
+public:
+    ShadowEvaluator(std::string target, ModelRunner candidate, std::string logPath,
+                    size_t maxQueue = 64, size_t maxDisagreementSamples = 200,
+                    size_t summaryEvery = 100,
+                    std::chrono::seconds summaryInterval = std::chrono::seconds(60))
+        : m_target(std::move(target)), m_candidate(std::move(candidate)),
+          m_logPath(std::move(logPath)), m_maxQueue(maxQueue),
+          m_maxDisagreements(maxDisagreementSamples), m_summaryEvery(summaryEvery),
+          m_summaryInterval(summaryInterval) {
+        m_worker = std::thread([this] { workerLoop(); });
+    }
+
+    ~ShadowEvaluator() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        if (m_worker.joinable())
+            m_worker.join();
+        writeSummary();
+    }
+
+    ShadowEvaluator(const ShadowEvaluator&) = delete;
+    ShadowEvaluator& operator=(const ShadowEvaluator&) = delete;
+
+    const std::string& target() const { return m_target; }
+    const std::string& candidatePath() const { return m_candidate.modelPath(); }
+    const std::string& logPath() const { return m_logPath; }
+
+    void submit(PointView pts, const std::string& primaryLabel, double primaryMs) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping)
+                return;
+            if (m_queue.size() >= m_maxQueue) {
+                ++m_dropped;
+                return;
+            }
+            m_queue.push_back({pts.toVector(), primaryLabel, primaryMs});
+        }
+        m_cv.notify_one();
+    }
+
+    // Blocks until every queued gesture has been evaluated.
+    void waitIdle() const {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCv.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+    }
+
+    ShadowStats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ShadowStats s;
+        s.samples = m_samples;
+        s.agreements = m_agreements;
+        s.dropped = m_dropped;
+        s.agreementRate = m_samples ? static_cast<double>(m_agreements) / m_samples : 0.0;
+        s.primaryP50Ms = percentile(m_primaryMs, 0.50);
+        s.candidateP50Ms = percentile(m_candidateMs, 0.50);
+        s.candidateP95Ms = percentile(m_candidateMs, 0.95);
+        s.candidateP99Ms = percentile(m_candidateMs, 0.99);
+        return s;
+    }
+
+    // Appends a summary line with the current agreement and latency numbers.
+    void writeSummary() const {
+        ShadowStats s = stats();
+        if (s.samples == 0 && s.dropped == 0)
+            return;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(4) << "{\"type\":\"summary\",\"target\":\""
+             << escape(m_target) << "\",\"candidate\":\"" << escape(candidatePath())
+             << "\",\"samples\":" << s.samples << ",\"agreements\":" << s.agreements
+             << ",\"dropped\":" << s.dropped << ",\"agreement_rate\":" << s.agreementRate
+             << ",\"primary_p50_ms\":" << s.primaryP50Ms
+             << ",\"candidate_p50_ms\":" << s.candidateP50Ms
+             << ",\"candidate_p95_ms\":" << s.candidateP95Ms
+             << ",\"candidate_p99_ms\":" << s.candidateP99Ms << "}";
+        appendLine(line.str());
+    }
+
+private:
+    struct Job {
+        std::vector<Point> points;
+        std::string primary;
+        double primaryMs;
+    };
+
+    // Latencies are kept in a bounded window so long sessions stay flat.
+    static constexpr size_t kLatencyWindow = 4096;
+
+    static double percentile(std::vector<double> values, double q) {
+        if (values.empty())
+            return 0.0;
+        size_t idx = static_cast<size_t>(q * static_cast<double>(values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + idx, values.end());
+        return values[idx];
+    }
+
+    static void pushWindow(std::vector<double>& window, size_t& next, double value) {
+        if (window.size() < kLatencyWindow) {
+            window.push_back(value);
+        } else {
+            window[next] = value;
+            next = (next + 1) % kLatencyWindow;
+        }
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                out += buf;
+            } else {
+                out.push_back(c);
+            }
+        }
+        return out;
+    }
+
+    void appendLine(const std::string& line) const {
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        std::ofstream out(m_logPath, std::ios::app);
+        if (!out.is_open()) {
+            SC_LOG(sc::LogLevel::Warn, "Cannot write shadow evaluation log " + m_logPath);
+            return;
+        }
+        out << line << '\n';
+    }
+
+    void workerLoop() {
+        auto lastSummary = std::chrono::steady_clock::now();
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty())
+                    return;
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_busy = true;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            std::string label = m_candidate.run(job.points);
+            double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+            const bool agree = label == job.primary;
+
+            bool logSample = false;
+            bool summaryDue = false;
+            const auto now = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_samples;
+                if (agree)
+                    ++m_agreements;
+                pushWindow(m_primaryMs, m_primaryNext, job.primaryMs);
+                pushWindow(m_candidateMs, m_candidateNext, ms);
+                if (!agree && m_loggedDisagreements < m_maxDisagreements) {
+                    ++m_loggedDisagreements;
+                    logSample = true;
+                }
+                // Only evaluated gestures change the numbers, so an idle
+                // evaluator has nothing new to write.
+                summaryDue = (m_summaryEvery > 0 && m_samples % m_summaryEvery == 0) ||
+                             now - lastSummary >= m_summaryInterval;
+            }
+            if (logSample) {
+                std::ostringstream line;
+                line << std::fixed << std::setprecision(4)
+                     << "{\"type\":\"disagreement\",\"target\":\"" << escape(m_target)
+                     << "\",\"primary\":\"" << escape(job.primary) << "\",\"candidate\":\""
+                     << escape(label) << "\",\"primary_ms\":" << job.primaryMs
+                     << ",\"candidate_ms\":" << ms << ",\"points\":[";
+                for (size_t i = 0; i < job.points.size(); ++i) {
+                    if (i)
+                        line << ',';
+                    line << '[' << job.points[i].x << ',' << job.points[i].y << ']';
+                }
+                line << "]}";
+                appendLine(line.str());
+            }
+            if (summaryDue) {
+                writeSummary();
+                lastSummary = now;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busy = false;
+            }
+            m_idleCv.notify_all();
+        }
+    }
+
+    std::string m_target;
+    ModelRunner m_candidate;
+    std::string m_logPath;
+    size_t m_maxQueue;
+    size_t m_maxDisagreements;
+    size_t m_summaryEvery;
+    std::chrono::seconds m_summaryInterval;
+    std::deque<Job> m_queue;
+    bool m_stopping{false};
+    bool m_busy{false};
+    size_t m_samples{0};
+    size_t m_agreements{0};
+    size_t m_dropped{0};
+    size_t m_loggedDisagreements{0};
+    std::vector<double> m_primaryMs;
+    std::vector<double> m_candidateMs;
+    size_t m_primaryNext{0};
+    size_t m_candidateNext{0};
+    mutable std::mutex m_mutex;
+    mutable std::mutex m_fileMutex;
+    std::condition_variable m_cv;
+    mutable std::condition_variable m_idleCv;
+    std::thread m_worker;
+};
+
+} // namespace sc
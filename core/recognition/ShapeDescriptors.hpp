@@ -0,0 +1,290 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "../input/InputManager.hpp"
+
+namespace sc {
+
+// Geometric summary of a gesture shared by the heuristic classifier and the
+// router so a stroke is only scanned once per recognition.
+struct ShapeDescriptors {
+    size_t pointCount{0};
+    float minX{0.f};
+    float maxX{0.f};
+    float minY{0.f};
+    float maxY{0.f};
+    float cx{0.f};
+    float cy{0.f};
+    float width{0.f};
+    float height{0.f};
+    float aspect{1.f};
+    float meanRadius{0.f};
+    float radiusStdDev{0.f};
+    float radialUniformity{1.f};
+    size_t hullSize{0};
+};
+
+// Number of Points describeShape() needs as scratch for n input points.
+inline size_t shapeScratchSize(size_t n) { return 2 * n + 4; }
+
+// Reusable scratch for describeShape(). It only grows, so steady-state
+// classification of similarly sized gestures does not touch the heap.
+class ShapeScratch {
+public:
+    Point* reserve(size_t n) {
+        const size_t needed = shapeScratchSize(n);
+        if (m_buffer.size() < needed)
+            m_buffer.resize(needed);
+        return m_buffer.data();
+    }
+    size_t capacity() const { return m_buffer.size(); }
+
+private:
+    std::vector<Point> m_buffer;
+};
+
+namespace detail {
+
+inline float cross(const Point& o, const Point& a, const Point& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+inline bool nearlyEqual(const Point& a, const Point& b) {
+    return std::fabs(a.x - b.x) < 1e-3f && std::fabs(a.y - b.y) < 1e-3f;
+}
+
+// True when the counter-clockwise polygon hull[0..h) is convex and contains
+// every point of `pts`, i.e. it is the convex hull of the path. Costs O(h)
+// plus O(log h) per point.
+inline bool hullContainsAll(const Point* hull, size_t h, PointView pts) {
+    // Every turn must be to the left, and the edges may only change
+    // horizontal direction twice; a polygon winding round more than once
+    // also turns left everywhere.
+    int directionChanges = 0;
+    float lastDx = 0.f;
+    for (size_t i = 0; i < h; ++i) {
+        const Point& a = hull[i];
+        const Point& b = hull[(i + 1) % h];
+        if (cross(a, b, hull[(i + 2) % h]) <= 0.f)
+            return false;
+        const float dx = b.x - a.x;
+        if (dx != 0.f) {
+            if (lastDx != 0.f && (dx > 0.f) != (lastDx > 0.f))
+                ++directionChanges;
+            lastDx = dx;
+        }
+    }
+    if (directionChanges > 2)
+        return false;
+
+    // Locate each point in the fan of triangles around hull[0].
+    const Point& o = hull[0];
+    for (size_t i = 0; i < pts.size(); ++i) {
+        const Point p = pts[i];
+        if (cross(o, hull[1], p) < 0.f || cross(o, hull[h - 1], p) > 0.f)
+            return false;
+        size_t lo = 1;
+        size_t hi = h - 1;
+        while (hi - lo > 1) {
+            const size_t mid = (lo + hi) / 2;
+            if (cross(o, hull[mid], p) >= 0.f)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        if (cross(hull[lo], hull[lo + 1], p) < 0.f)
+            return false;
+    }
+    return true;
+}
+
+// Vertex count of the exact convex hull: Andrew's monotone chain over a
+// sorted copy of the points, as the classifier originally computed it.
+// Needs 2 * n + 1 points of scratch.
+inline size_t exactHullSize(PointView pts, Point* scratch) {
+    const size_t n = pts.size();
+    Point* sorted = scratch;
+    for (size_t i = 0; i < n; ++i)
+        sorted[i] = pts[i];
+    std::sort(sorted, sorted + n, [](const Point& a, const Point& b) {
+        if (a.x == b.x)
+            return a.y < b.y;
+        return a.x < b.x;
+    });
+    const size_t m = static_cast<size_t>(std::unique(sorted, sorted + n, nearlyEqual) - sorted);
+    if (m < 3)
+        return m;
+
+    Point* hull = scratch + n;
+    size_t k = 0;
+    for (size_t i = 0; i < m; ++i) {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0.f)
+            --k;
+        hull[k++] = sorted[i];
+    }
+    for (size_t i = m - 1, t = k + 1; i-- > 0;) {
+        while (k >= t && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0.f)
+            --k;
+        hull[k++] = sorted[i];
+    }
+    return k > 1 ? k - 1 : k;
+}
+
+} // namespace detail
+
+// Computes descriptors in two streaming passes: one for the bounding box,
+// the centroid and Melkman's convex hull of the path, and one Welford pass
+// for the radial spread around the centroid. `scratch` must hold at least
+// shapeScratchSize(n) points; no memory is allocated. Melkman's hull is only
+// exact for simple polylines, and hand-drawn paths often cross themselves,
+// so the result is checked against every point and the exact sort-based
+// hull is computed in the scratch buffer when the check fails.
+inline ShapeDescriptors describeShape(PointView pts, Point* scratch, size_t scratchSize) {
+    const size_t n = pts.size();
+    ShapeDescriptors d;
+    d.pointCount = n;
+    if (n == 0)
+        return d;
+
+    d.minX = d.maxX = pts.x(0);
+    d.minY = d.maxY = pts.y(0);
+    double sumX = 0.0;
+    double sumY = 0.0;
+
+    // Melkman deque lives in scratch; the hull is closed (D[bot] == D[top]).
+    const bool hullEnabled = scratch && scratchSize >= shapeScratchSize(n);
+    Point* deque = scratch;
+    size_t bot = n;
+    size_t top = n;
+    bool hullStarted = false;
+    size_t distinct = 0;
+    Point first{};
+    Point second{};
+    Point last{};
+
+    for (size_t i = 0; i < n; ++i) {
+        const Point p = pts[i];
+        d.minX = std::min(d.minX, p.x);
+        d.maxX = std::max(d.maxX, p.x);
+        d.minY = std::min(d.minY, p.y);
+        d.maxY = std::max(d.maxY, p.y);
+        sumX += p.x;
+        sumY += p.y;
+
+        if (!hullEnabled || (distinct > 0 && detail::nearlyEqual(p, last)))
+            continue;
+        last = p;
+
+        if (!hullStarted) {
+            if (distinct == 0) {
+                first = p;
+                ++distinct;
+            } else if (distinct == 1) {
+                second = p;
+                ++distinct;
+            } else {
+                const float turn = detail::cross(first, second, p);
+                if (std::fabs(turn) <= 1e-6f) {
+                    // Still collinear: keep the two extremes of the segment.
+                    const float dx = second.x - first.x;
+                    const float dy = second.y - first.y;
+                    const float t = (p.x - first.x) * dx + (p.y - first.y) * dy;
+                    if (t < 0.f)
+                        first = p;
+                    else if (t > dx * dx + dy * dy)
+                        second = p;
+                    continue;
+                }
+                ++distinct;
+                deque[bot] = p;
+                if (turn > 0.f) {
+                    deque[bot + 1] = first;
+                    deque[bot + 2] = second;
+                } else {
+                    deque[bot + 1] = second;
+                    deque[bot + 2] = first;
+                }
+                top = bot + 3;
+                deque[top] = p;
+                hullStarted = true;
+            }
+            continue;
+        }
+
+        // Points inside or on the boundary of the wedge at the last hull
+        // vertex cannot change the hull (this also drops repeated vertices).
+        if (detail::cross(deque[bot], deque[bot + 1], p) >= 0.f &&
+            detail::cross(deque[top - 1], deque[top], p) >= 0.f)
+            continue;
+        while (top - bot > 2 && detail::cross(deque[bot], deque[bot + 1], p) <= 0.f)
+            ++bot;
+        deque[--bot] = p;
+        while (top - bot > 2 && detail::cross(deque[top - 1], deque[top], p) <= 0.f)
+            --top;
+        deque[++top] = p;
+    }
+
+    const float count = static_cast<float>(n);
+    d.cx = static_cast<float>(sumX / n);
+    d.cy = static_cast<float>(sumY / n);
+    d.width = std::max(1e-3f, d.maxX - d.minX);
+    d.height = std::max(1e-3f, d.maxY - d.minY);
+    d.aspect = d.width > d.height ? d.width / d.height : d.height / d.width;
+    if (hullStarted) {
+        d.hullSize = top - bot;
+        if (!detail::hullContainsAll(deque + bot, d.hullSize, pts))
+            d.hullSize = detail::exactHullSize(pts, scratch);
+    } else {
+        d.hullSize = distinct;
+    }
+
+    // Welford's running mean/variance of the distance to the centroid.
+    double mean = 0.0;
+    double m2 = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const double dx = pts.x(i) - d.cx;
+        const double dy = pts.y(i) - d.cy;
+        const double r = std::sqrt(dx * dx + dy * dy);
+        const double delta = r - mean;
+        mean += delta / static_cast<double>(i + 1);
+        m2 += delta * (r - mean);
+    }
+    d.meanRadius = static_cast<float>(mean);
+    const float variance = static_cast<float>(m2) / std::max(1.f, count - 1.f);
+    d.radiusStdDev = std::sqrt(variance);
+    d.radialUniformity = d.meanRadius > 1e-3f ? d.radiusStdDev / d.meanRadius : 1.f;
+    return d;
+}
+
+inline ShapeDescriptors describeShape(const Point* pts, size_t n, Point* scratch,
+                                      size_t scratchSize) {
+    return describeShape(PointView(pts, n), scratch, scratchSize);
+}
+
+inline ShapeDescriptors describeShape(PointView pts, ShapeScratch& scratch) {
+    Point* buffer = scratch.reserve(pts.size());
+    return describeShape(pts, buffer, scratch.capacity());
+}
+
+// Maps descriptors to one of the built-in shape labels.
+inline const char* classifyShape(const ShapeDescriptors& d) {
+    if (d.pointCount == 0)
+        return "";
+    if (d.pointCount <= 2)
+        return "circle";
+    if (d.hullSize >= 4 && d.aspect < 1.3f)
+        return "square";
+    if (d.hullSize == 3)
+        return "triangle";
+    if (d.radialUniformity < 0.25f)
+        return "circle";
+    if (d.aspect < 1.2f && d.pointCount > 12)
+        return "square";
+    if (d.pointCount > 10)
+        return "triangle";
+    return "circle";
+}
+
+} // namespace sc
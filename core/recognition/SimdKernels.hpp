@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SC_SIMD_SSE2 1
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define SC_SIMD_NEON 1
+#  include <arm_neon.h>
+#endif
+
+namespace sc {
+namespace simd {
+
+// Small float kernels shared by the native inference paths. Each has an
+// SSE2 or NEON body for four lanes at a time and a scalar tail.
+
+inline float dot(const float* a, const float* b, size_t n) {
+    size_t i = 0;
+    float sum = 0.f;
+#if defined(SC_SIMD_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(SC_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.f);
+    for (; i + 4 <= n; i += 4)
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+inline float squaredDistance(const float* a, const float* b, size_t n) {
+    size_t i = 0;
+    float sum = 0.f;
+#if defined(SC_SIMD_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        acc = _mm_add_ps(acc, _mm_mul_ps(d, d));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(SC_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t d = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        acc = vmlaq_f32(acc, d, d);
+    }
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+    for (; i < n; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// out[i] = (in[i] - shift[i]) * mul[i]
+inline void affine(const float* in, const float* shift, const float* mul, float* out, size_t n) {
+    size_t i = 0;
+#if defined(SC_SIMD_SSE2)
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_sub_ps(_mm_loadu_ps(in + i), _mm_loadu_ps(shift + i));
+        _mm_storeu_ps(out + i, _mm_mul_ps(v, _mm_loadu_ps(mul + i)));
+    }
+#elif defined(SC_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vsubq_f32(vld1q_f32(in + i), vld1q_f32(shift + i));
+        vst1q_f32(out + i, vmulq_f32(v, vld1q_f32(mul + i)));
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = (in[i] - shift[i]) * mul[i];
+}
+
+} // namespace simd
+} // namespace sc
@@ -0,0 +1,218 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace sc {
+
+// Appends decoded UTF-8 to `out`, replacing malformed or truncated sequences
+// with U+FFFD. Returns false if anything was replaced.
+inline bool appendUtf8(const char* data, size_t size, std::u32string& out) {
+    bool valid = true;
+    const auto* s = reinterpret_cast<const uint8_t*>(data);
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t lead = s[i];
+        size_t len = 0;
+        char32_t cp = 0;
+        if (lead < 0x80) {
+            out.push_back(lead);
+            ++i;
+            continue;
+        } else if ((lead & 0xe0) == 0xc0) {
+            len = 2;
+            cp = lead & 0x1f;
+        } else if ((lead & 0xf0) == 0xe0) {
+            len = 3;
+            cp = lead & 0x0f;
+        } else if ((lead & 0xf8) == 0xf0) {
+            len = 4;
+            cp = lead & 0x07;
+        }
+        bool ok = len != 0 && i + len <= size;
+        for (size_t k = 1; ok && k < len; ++k) {
+            if ((s[i + k] & 0xc0) != 0x80)
+                ok = false;
+            else
+                cp = (cp << 6) | (s[i + k] & 0x3f);
+        }
+        // Reject overlong forms, surrogates and values past U+10FFFF.
+        static const char32_t kMin[5] = {0, 0, 0x80, 0x800, 0x10000};
+        if (ok && (cp < kMin[len] || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)))
+            ok = false;
+        if (!ok) {
+            out.push_back(U'\uFFFD');
+            valid = false;
+            ++i;
+            continue;
+        }
+        out.push_back(cp);
+        i += len;
+    }
+    return valid;
+}
+
+inline std::u32string utf8ToUtf32(const char* data, size_t size) {
+    std::u32string out;
+    out.reserve(size);
+    appendUtf8(data, size, out);
+    return out;
+}
+
+// Token-id to text table for a TrOCR vocabulary, written next to the ONNX
+// graphs by scripts/export_trocr.py (--onnx) so decoding needs no tokenizer
+// library. Little-endian layout:
+//
+//   "SCTK" u32 version u32 count i32 startToken i32 eosToken
+//   u32 offsets[count + 1] u8 flags[count] bytes[offsets[count]]
+//
+// Token i is the byte range [offsets[i], offsets[i + 1]): its UTF-8 text with
+// the tokenizer's byte-level or sentencepiece encoding undone, so one token
+// may hold part of a multi-byte character. Flag bit 0 marks special tokens,
+// which decode() skips.
+//
+// Loading also precomputes every token's UTF-32 text into one flat array, so
+// decode() is a series of span copies with no UTF-8 or string round trips.
+// Only tokens holding a partial character need the byte path, and only
+// sequences containing one take it.
+class TokenTable {
+public:
+    static constexpr uint8_t kSpecial = 1;
+
+    static bool hasMagic(const void* data, size_t size) {
+        return size >= 4 && std::memcmp(data, "SCTK", 4) == 0;
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return false;
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                std::istreambuf_iterator<char>());
+        return loadFromMemory(bytes.data(), bytes.size());
+    }
+
+    bool loadFromMemory(const void* data, size_t size) {
+        *this = TokenTable();
+        if (!hasMagic(data, size))
+            return false;
+        const auto* p = static_cast<const uint8_t*>(data);
+        size_t pos = 4;
+        auto u32 = [&](uint32_t& v) {
+            if (size - pos < 4)
+                return false;
+            v = static_cast<uint32_t>(p[pos]) | (static_cast<uint32_t>(p[pos + 1]) << 8) |
+                (static_cast<uint32_t>(p[pos + 2]) << 16) | (static_cast<uint32_t>(p[pos + 3]) << 24);
+            pos += 4;
+            return true;
+        };
+        uint32_t version = 0;
+        uint32_t count = 0;
+        uint32_t start = 0;
+        uint32_t eos = 0;
+        if (!u32(version) || version != 1 || !u32(count) || count == 0 || !u32(start) ||
+            !u32(eos) || start >= count || eos >= count)
+            return false;
+        if (count > (size - pos) / 5)
+            return false;
+        m_offsets.resize(static_cast<size_t>(count) + 1);
+        for (auto& offset : m_offsets) {
+            if (!u32(offset))
+                return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (m_offsets[i] > m_offsets[i + 1])
+                return false;
+        }
+        if (size - pos < count || size - pos - count < m_offsets.back())
+            return false;
+        m_flags.assign(p + pos, p + pos + count);
+        pos += count;
+        m_bytes.assign(reinterpret_cast<const char*>(p + pos), m_offsets.back());
+
+        m_utf32Offsets.resize(static_cast<size_t>(count) + 1);
+        m_utf32Offsets[0] = 0;
+        for (size_t i = 0; i < count; ++i) {
+            m_flags[i] &= kSpecial;
+            if (!(m_flags[i] & kSpecial)) {
+                const size_t before = m_utf32.size();
+                if (!appendUtf8(m_bytes.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i],
+                                m_utf32)) {
+                    m_utf32.resize(before);
+                    m_flags[i] |= kPartial;
+                }
+            }
+            m_utf32Offsets[i + 1] = static_cast<uint32_t>(m_utf32.size());
+        }
+        m_startToken = static_cast<int32_t>(start);
+        m_eosToken = static_cast<int32_t>(eos);
+        m_loaded = true;
+        return true;
+    }
+
+    bool loaded() const { return m_loaded; }
+    size_t size() const { return m_flags.size(); }
+    int64_t startToken() const { return m_startToken; }
+    int64_t eosToken() const { return m_eosToken; }
+
+    bool isSpecial(uint32_t id) const { return id >= size() || (m_flags[id] & kSpecial) != 0; }
+
+    // UTF-8 bytes of one token; empty for special or unknown ids.
+    std::string tokenBytes(uint32_t id) const {
+        if (isSpecial(id))
+            return std::string();
+        return m_bytes.substr(m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+    }
+
+    // Precomputed text of one token; empty for special, unknown or partial
+    // tokens.
+    std::u32string tokenText(uint32_t id) const {
+        if (isSpecial(id))
+            return std::u32string();
+        return std::u32string(m_utf32.data() + m_utf32Offsets[id],
+                              m_utf32Offsets[id + 1] - m_utf32Offsets[id]);
+    }
+
+    bool isPartial(uint32_t id) const { return id < size() && (m_flags[id] & kPartial) != 0; }
+
+    std::u32string decode(const std::vector<uint32_t>& ids) const {
+        std::u32string out;
+        for (uint32_t id : ids) {
+            if (isSpecial(id))
+                continue;
+            if (m_flags[id] & kPartial)
+                return decodeBytes(ids);
+            out.append(m_utf32.data() + m_utf32Offsets[id], m_utf32Offsets[id + 1] - m_utf32Offsets[id]);
+        }
+        return out;
+    }
+
+private:
+    // Set at load time for tokens that are not complete UTF-8 on their own.
+    static constexpr uint8_t kPartial = 2;
+
+    // Concatenates the tokens' bytes before decoding UTF-8, so characters
+    // split across tokens come out whole.
+    std::u32string decodeBytes(const std::vector<uint32_t>& ids) const {
+        std::string utf8;
+        for (uint32_t id : ids) {
+            if (!isSpecial(id))
+                utf8.append(m_bytes, m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+        }
+        return utf8ToUtf32(utf8.data(), utf8.size());
+    }
+
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint8_t> m_flags;
+    std::string m_bytes;
+    std::vector<uint32_t> m_utf32Offsets;
+    std::u32string m_utf32;
+    int64_t m_startToken{0};
+    int64_t m_eosToken{0};
+    bool m_loaded{false};
+};
+
+} // namespace sc
@@ -1,19 +1,53 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <QImage>
 #include <QString>
 
+#include "ImagePreprocess.hpp"
+#include "TokenTable.hpp"
+#include "TrocrOnnx.hpp"
 #include "utils/Logger.hpp"
 
+// Defined when at least one decoder backend is compiled in.
+#if defined(SC_ENABLE_TROCR) || defined(SC_USE_ONNXRUNTIME)
+#define SC_TROCR_BACKEND 1
+#endif
+
 namespace sc {
 
+// Decodes rendered glyphs with a TrOCR model. Concurrent
+// callers run in parallel on a pool of execution replicas: the loaded module
+// is shared read-only (TorchScript inference does not mutate it) and each
+// replica owns its input tensor, so only replica checkout and the tokenizer
+// fallback are serialized. Token ids are normally turned into text through a
+// precomputed TokenTable.
+//
+// Two module layouts are accepted. A plain traced model whose forward()
+// returns logits for a fixed-length sequence is decoded with one argmax. A
+// generator exported by scripts/export_trocr.py exposes encode(),
+// decode_first() and decode_next() and is decoded incrementally: the
+// encoder runs once, the decoder is stepped with cached key/values, and
+// generation stops at EOS or after maxLength tokens, greedily or with a
+// small beam.
+//
+// The model runs on LibTorch (SC_ENABLE_TROCR, the default backend) or on
+// ONNX Runtime (SC_USE_ONNXRUNTIME). For the ONNX backend the model path is
+// a directory written by export_trocr.py --onnx: its graphs run on the
+// process-wide ONNX Runtime environment and thread pools that ModelRunner
+// uses, and its tokens.bin table replaces the tokenizer.
 class TrocrDecoder {
 public:
+  enum class Backend { Torch, Onnx };
+
   TrocrDecoder() = default;
   TrocrDecoder(std::string modelPath, std::string tokenizerPath,
                int expectedSize = 384)
@@ -26,12 +60,35 @@ public:
     m_moduleLoaded = false;
   }
 
+  void setBackend(Backend backend) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (backend == m_backend)
+      return;
+    m_backend = backend;
+    m_moduleLoaded = false;
+    m_tokenizerLoaded = false;
+  }
+
+  Backend backend() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_backend;
+  }
+
   void setTokenizerPath(std::string path) {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_tokenizerPath = std::move(path);
     m_tokenizerLoaded = false;
   }
 
+  // tokens.bin written by export_trocr.py. When set, the LibTorch backend
+  // decodes through it and only falls back to the tokenizer if it cannot be
+  // loaded.
+  void setTokenTablePath(std::string path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tokenTablePath = std::move(path);
+    m_tokenizerLoaded = false;
+  }
+
   void setExpectedInputSize(int size) {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_inputSize = size;
@@ -42,74 +99,327 @@ public:
     return m_inputSize;
   }
 
+  // Maximum number of decodes that run at the same time. Replicas are
+  // created lazily, so an unused pool costs nothing.
+  void setReplicaCount(int count) {
+    {
+      std::lock_guard<std::mutex> lock(m_poolMutex);
+      m_replicaCount = static_cast<size_t>(std::max(1, count));
+    }
+    m_poolCv.notify_all();
+  }
+
+  int replicaCount() const {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    return static_cast<int>(m_replicaCount);
+  }
+
+  // Intra-op threads each decode's forward pass may use; 0 splits the cores
+  // between the decodes running when a decode starts. With LibTorch's
+  // OpenMP backend this is a per-thread setting, applied on the decoding
+  // thread for every decode. Native thread-pool builds have one intra-op
+  // pool per process, which is sized once when the module loads.
+  void setIntraOpThreads(int threads) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_intraOpThreads = std::max(0, threads);
+    m_threadsApplied = false;
+  }
+
+  // Inter-op threads for the whole process (0 keeps ATen's default). ATen
+  // only accepts this before its inter-op pool starts, so later changes are
+  // logged and ignored.
+  void setInterOpThreads(int threads) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_interOpThreads = std::max(0, threads);
+    m_threadsApplied = false;
+  }
+
+  // Freezes the module and runs optimize_for_inference on it after loading:
+  // parameters become constants and ops are fused for the CPU. Modules that
+  // cannot be frozen (e.g. ones already frozen at export) load unchanged.
+  void setOptimizeOnLoad(bool optimize) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (optimize != m_optimizeOnLoad)
+      m_moduleLoaded = false;
+    m_optimizeOnLoad = optimize;
+  }
+
+  // Upper bound on generated tokens for incremental modules.
+  void setMaxLength(int tokens) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxLength = std::max(1, tokens);
+  }
+
+  // 1 decodes greedily; larger values keep that many beams.
+  void setNumBeams(int beams) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_numBeams = std::max(1, std::min(beams, kMaxBeams));
+  }
+
   bool available() const {
     std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_backend == Backend::Onnx) {
+#ifdef SC_USE_ONNXRUNTIME
+      return !m_modelPath.empty();
+#endif
+    } else {
 #ifdef SC_ENABLE_TROCR
-    return !m_modelPath.empty() && !m_tokenizerPath.empty();
-#else
-    return false;
+      return !m_modelPath.empty() &&
+             (!m_tokenizerPath.empty() || !m_tokenTablePath.empty());
 #endif
+    }
+    return false;
+  }
+
+  // Returns an empty string if `cancel` becomes true before decoding ends;
+  // incremental modules check it between decoder steps.
+  std::u32string decode(const QImage &glyph,
+                        const std::atomic<bool> *cancel = nullptr) {
+    std::vector<std::u32string> out = decodeBatch(&glyph, 1, cancel);
+    return out.empty() ? std::u32string() : std::move(out.front());
   }
 
-  std::u32string decode(const QImage &glyph) {
+  // Decodes several glyphs with one {N,3,H,W} forward pass (and one
+  // batched decoder loop for incremental modules). Glyphs are scaled to the
+  // size of the first one. Returns one string per glyph, or an empty vector
+  // on failure or cancellation.
+  std::vector<std::u32string> decodeBatch(const QImage *glyphs, size_t count,
+                                          const std::atomic<bool> *cancel = nullptr) {
+    if (!glyphs || count == 0 || glyphs[0].isNull())
+      return {};
+    const int width = glyphs[0].width();
+    const int height = glyphs[0].height();
+    return decodeWith(count, width, height, cancel, [&](size_t i, float *planes) {
+      // Packed 32-bit formats are read in place; anything else is converted
+      // once.
+      QImage rgb = glyphs[i];
+      if (rgb.isNull())
+        return false;
+      if (rgb.width() != width || rgb.height() != height)
+        rgb = rgb.scaled(width, height, Qt::IgnoreAspectRatio,
+                         Qt::SmoothTransformation);
+      PixelLayout layout = PixelLayout::Rgba;
+      if (!pixelLayoutFor(rgb.format(), layout)) {
+        rgb = rgb.convertToFormat(QImage::Format_RGBA8888);
+        layout = PixelLayout::Rgba;
+      }
+      packedToPlanar(rgb.constBits(), width, height,
+                     static_cast<size_t>(rgb.bytesPerLine()), layout,
+                     kTrocrNorm, planes);
+      return true;
+    });
+  }
+
+  std::vector<std::u32string> decodeBatch(const std::vector<QImage> &glyphs,
+                                          const std::atomic<bool> *cancel = nullptr) {
+    return decodeBatch(glyphs.data(), glyphs.size(), cancel);
+  }
+
+  // Decodes an ink-coverage buffer from GlyphRasterizer (width*height floats,
+  // 1 = ink) without going through a QImage.
+  std::u32string decodeCoverage(const float *coverage, int width, int height,
+                                const std::atomic<bool> *cancel = nullptr) {
+    if (!coverage)
+      return {};
+    std::vector<std::u32string> out =
+        decodeWith(1, width, height, cancel, [&](size_t, float *planes) {
+          coverageToPlanar(coverage, width, height, kTrocrNorm, planes);
+          return true;
+        });
+    return out.empty() ? std::u32string() : std::move(out.front());
+  }
+
+  // Loads the module and tokenizer without decoding anything. Returns false
+  // if either fails to load.
+  bool load() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+#ifdef SC_USE_ONNXRUNTIME
+    if (m_backend == Backend::Onnx)
+      return ensureOnnxLoaded();
+#endif
 #ifdef SC_ENABLE_TROCR
+    if (m_backend == Backend::Torch)
+      return ensureLoaded();
+#endif
+    return false;
+  }
+
+  // Loads the module and tokenizer and pushes one blank glyph through them
+  // so the first user-facing decode does not pay the lazy-load cost.
+  bool warmUp() {
+#ifdef SC_TROCR_BACKEND
+    const int size = expectedInputSize();
+    const std::vector<float> blank(static_cast<size_t>(size) * size, 0.f);
+    decodeCoverage(blank.data(), size, size);
     std::lock_guard<std::mutex> lock(m_mutex);
-    if (!ensureLoaded())
-      return {};
-    if (glyph.isNull())
+    return m_moduleLoaded && m_tokenizerLoaded;
+#else
+    return false;
+#endif
+  }
+
+private:
+  // Shared body of the decode entry points: `fill(i, planes)` writes glyph
+  // i's normalized CHW planes straight into the replica's reused {N,3,H,W}
+  // tensor, so each glyph is touched once with no clone or permute.
+  template <typename Fill>
+  std::vector<std::u32string> decodeWith(size_t count, int width, int height,
+                                         const std::atomic<bool> *cancel,
+                                         Fill &&fill) {
+    if (count == 0 || width <= 0 || height <= 0)
       return {};
+    const Backend active = backend();
+#ifdef SC_USE_ONNXRUNTIME
+    if (active == Backend::Onnx)
+      return decodeOnnx(count, width, height, cancel, fill);
+#endif
+#ifdef SC_ENABLE_TROCR
+    if (active == Backend::Torch)
+      return decodeTorch(count, width, height, cancel, fill);
+#endif
+    Q_UNUSED(active);
+    Q_UNUSED(cancel);
+    Q_UNUSED(fill);
+    return {};
+  }
 
-    QImage rgb = glyph;
-    if (rgb.format() != QImage::Format_RGBA8888 &&
-        rgb.format() != QImage::Format_RGB32 &&
-        rgb.format() != QImage::Format_ARGB32 &&
-        rgb.format() != QImage::Format_RGB888) {
-      rgb = glyph.convertToFormat(QImage::Format_RGBA8888);
+#ifdef SC_USE_ONNXRUNTIME
+  template <typename Fill>
+  std::vector<std::u32string> decodeOnnx(size_t count, int width, int height,
+                                         const std::atomic<bool> *cancel,
+                                         Fill &fill) {
+    std::shared_ptr<const TrocrOnnxModel> model;
+    std::shared_ptr<const TokenTable> tokens;
+    GenerationConfig generation;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!ensureOnnxLoaded())
+        return {};
+      model = m_onnx;
+      tokens = m_tokens;
+      generation = m_generation;
+      generation.maxLength = m_maxLength;
+      generation.numBeams = m_numBeams;
     }
-    if (rgb.format() == QImage::Format_RGB888) {
-      rgb = rgb.convertToFormat(QImage::Format_RGBA8888);
+
+    try {
+      std::vector<std::vector<uint32_t>> tokenIds;
+      {
+        ReplicaLease replica(*this);
+        const size_t glyphFloats = static_cast<size_t>(3) * width * height;
+        std::vector<float> &planes = replica->planes;
+        planes.resize(count * glyphFloats);
+        for (size_t i = 0; i < count; ++i) {
+          if (!fill(i, planes.data() + i * glyphFloats))
+            return {};
+        }
+        tokenIds = model->generate(planes.data(), static_cast<int64_t>(count),
+                                   height, width, generation, cancel);
+      }
+      if (isCancelled(cancel) || tokenIds.size() != count)
+        return {};
+      std::vector<std::u32string> results;
+      results.reserve(count);
+      for (const auto &ids : tokenIds)
+        results.push_back(tokens->decode(ids));
+      return results;
+    } catch (const Ort::Exception &ex) {
+      SC_LOG(sc::LogLevel::Error,
+             std::string("TrOCR inference failed: ") + ex.what());
+    } catch (...) {
+      SC_LOG(sc::LogLevel::Error, std::string("TrOCR inference failed"));
     }
+    return {};
+  }
 
-    const int width = rgb.width();
-    const int height = rgb.height();
-    if (width <= 0 || height <= 0)
-      return {};
+  bool ensureOnnxLoaded() {
+    if (m_moduleLoaded && m_tokenizerLoaded)
+      return true;
+    if (m_modelPath.empty())
+      return false;
+    auto tokens = std::make_shared<TokenTable>();
+    const std::string tablePath = m_modelPath + "/tokens.bin";
+    if (!tokens->load(tablePath)) {
+      SC_LOG(sc::LogLevel::Error,
+             "TrOCR token table " + tablePath + " is missing or malformed.");
+      return false;
+    }
+    auto model = std::make_shared<TrocrOnnxModel>();
+    if (!model->load(m_modelPath))
+      return false;
+    m_generation = GenerationConfig();
+    m_generation.incremental = true;
+    m_generation.startToken = tokens->startToken();
+    m_generation.eosToken = tokens->eosToken();
+    m_onnx = std::move(model);
+    m_tokens = std::move(tokens);
+    m_moduleLoaded = true;
+    m_tokenizerLoaded = true;
+    return true;
+  }
+#endif
 
-    const size_t kChannels = 3;
-    std::vector<float> buffer(static_cast<size_t>(width) * height * kChannels);
-    for (int y = 0; y < height; ++y) {
-      const uchar *line = rgb.constScanLine(y);
-      for (int x = 0; x < width; ++x) {
-        const uchar *pixel = line + x * 4;
-        const float r = static_cast<float>(pixel[2]) / 255.f;
-        const float g = static_cast<float>(pixel[1]) / 255.f;
-        const float b = static_cast<float>(pixel[0]) / 255.f;
-        const size_t idx = (static_cast<size_t>(y) * width + x) * kChannels;
-        buffer[idx] = (r - 0.5f) / 0.5f;
-        buffer[idx + 1] = (g - 0.5f) / 0.5f;
-        buffer[idx + 2] = (b - 0.5f) / 0.5f;
-      }
+#ifdef SC_ENABLE_TROCR
+  template <typename Fill>
+  std::vector<std::u32string> decodeTorch(size_t count, int width, int height,
+                                          const std::atomic<bool> *cancel,
+                                          Fill &fill) {
+    std::shared_ptr<torch::jit::Module> module;
+    std::shared_ptr<const TokenTable> tokens;
+    std::shared_ptr<tokenizers::Tokenizer> tokenizer;
+    GenerationConfig generation;
+    int intraOpThreads = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!ensureLoaded())
+        return {};
+      module = m_module;
+      tokens = m_tokens;
+      tokenizer = m_tokenizer;
+      generation = m_generation;
+      generation.maxLength = m_maxLength;
+      generation.numBeams = m_numBeams;
+      intraOpThreads = m_intraOpThreads;
     }
 
     try {
-      torch::NoGradGuard guard;
-      torch::Tensor input =
-          torch::from_blob(buffer.data(), {1, height, width, 3}).clone();
-      input = input.permute({0, 3, 1, 2});
-      std::vector<torch::jit::IValue> inputs{input};
-      torch::Tensor logits = m_module->forward(inputs).toTensor();
-      torch::Tensor ids = logits.argmax(-1).to(torch::kCPU).squeeze(0);
-      if (ids.dim() == 0)
+      std::vector<std::vector<uint32_t>> tokenIds;
+      {
+        ReplicaLease replica(*this);
+        useIntraOpThreads(intraOpThreads, replica.concurrent());
+        torch::NoGradGuard guard;
+        const int64_t batch = static_cast<int64_t>(count);
+        torch::Tensor &input = replica->input;
+        if (!input.defined() || input.size(0) != batch ||
+            input.size(2) != height || input.size(3) != width)
+          input = torch::empty({batch, 3, height, width}, torch::kFloat32);
+        const size_t glyphFloats = static_cast<size_t>(3) * width * height;
+        for (size_t i = 0; i < count; ++i) {
+          if (!fill(i, input.data_ptr<float>() + i * glyphFloats))
+            return {};
+        }
+        if (generation.incremental)
+          tokenIds = generate(*module, input, generation, cancel);
+        else
+          tokenIds = singlePass(*module, input);
+      }
+      if (isCancelled(cancel) || tokenIds.size() != count)
         return {};
-      const auto *data = ids.data_ptr<int64_t>();
-      const size_t len = static_cast<size_t>(ids.numel());
-      std::vector<uint32_t> tokenIds(len);
-      for (size_t i = 0; i < len; ++i)
-        tokenIds[i] = static_cast<uint32_t>(data[i]);
-      std::string text = m_tokenizer->decode(tokenIds, true);
-      QString qtext = QString::fromStdString(text);
-      auto u32 = qtext.toUcs4();
-      return std::u32string(u32.begin(), u32.end());
+      std::vector<std::u32string> results;
+      results.reserve(count);
+      for (const auto &ids : tokenIds) {
+        if (tokens) {
+          results.push_back(tokens->decode(ids));
+          continue;
+        }
+        std::string text;
+        if (!ids.empty()) {
+          std::lock_guard<std::mutex> lock(m_tokenizerMutex);
+          text = tokenizer->decode(ids, true);
+        }
+        results.push_back(utf8ToUtf32(text.data(), text.size()));
+      }
+      return results;
     } catch (const c10::Error &err) {
       SC_LOG(sc::LogLevel::Error,
              std::string("TrOCR inference failed: ") + err.what_without_backtrace());
@@ -118,20 +428,375 @@ public:
                                       ex.what());
     }
     return {};
-#else
-    Q_UNUSED(glyph);
-    return {};
+  }
 #endif
+
+  static bool pixelLayoutFor(QImage::Format format, PixelLayout &layout) {
+    switch (format) {
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+      layout = PixelLayout::Rgba;
+      return true;
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+      // 0xAARRGGBB words: B,G,R,A in memory on little-endian hosts.
+      layout = Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? PixelLayout::Bgra
+                                               : PixelLayout::Argb;
+      return true;
+    default:
+      return false;
+    }
   }
 
-private:
+  static constexpr int kMaxBeams = 8;
+
+  static bool isCancelled(const std::atomic<bool> *cancel) {
+    return trocrCancelled(cancel);
+  }
+
+  // Snapshot of what a decode needs, taken under m_mutex.
+  using GenerationConfig = TrocrGenerationConfig;
+
+  // Per-replica execution state. Replicas share the model; the input
+  // buffer is the only thing a forward pass writes.
+  struct Replica {
+#ifdef SC_ENABLE_TROCR
+    torch::Tensor input;
+#endif
+    std::vector<float> planes; // ONNX Runtime input
+  };
+
+  // Checks out an idle replica for the lifetime of the lease, blocking while
+  // all of them are busy.
+  class ReplicaLease {
+  public:
+    explicit ReplicaLease(TrocrDecoder &owner) : m_owner(owner) {
+      std::unique_lock<std::mutex> lock(owner.m_poolMutex);
+      owner.m_poolCv.wait(lock, [&owner] {
+        return !owner.m_idle.empty() || owner.m_busy < owner.m_replicaCount;
+      });
+      if (!owner.m_idle.empty()) {
+        m_replica = std::move(owner.m_idle.back());
+        owner.m_idle.pop_back();
+      } else {
+        m_replica = std::make_unique<Replica>();
+      }
+      m_concurrent = ++owner.m_busy;
+    }
+
+    ~ReplicaLease() {
+      {
+        std::lock_guard<std::mutex> lock(m_owner.m_poolMutex);
+        --m_owner.m_busy;
+        // Replicas beyond a reduced pool size are dropped on return.
+        if (m_owner.m_idle.size() + m_owner.m_busy < m_owner.m_replicaCount)
+          m_owner.m_idle.push_back(std::move(m_replica));
+      }
+      m_owner.m_poolCv.notify_one();
+    }
+
+    ReplicaLease(const ReplicaLease &) = delete;
+    ReplicaLease &operator=(const ReplicaLease &) = delete;
+
+    Replica *operator->() { return m_replica.get(); }
+
+    // Decodes running when this lease was taken, including its own.
+    size_t concurrent() const { return m_concurrent; }
+
+  private:
+    TrocrDecoder &m_owner;
+    std::unique_ptr<Replica> m_replica;
+    size_t m_concurrent{1};
+  };
+
 #ifdef SC_ENABLE_TROCR
+  static std::vector<uint32_t> toTokenIds(const std::vector<int64_t> &ids) {
+    return std::vector<uint32_t>(ids.begin(), ids.end());
+  }
+
+  // Legacy traced modules: one forward over a fixed-length sequence.
+  static std::vector<std::vector<uint32_t>>
+  singlePass(torch::jit::Module &module, const torch::Tensor &input) {
+    std::vector<torch::jit::IValue> inputs{input};
+    torch::Tensor logits = module.forward(inputs).toTensor();
+    torch::Tensor ids = logits.argmax(-1).to(torch::kCPU).contiguous();
+    if (ids.dim() != 2)
+      return {};
+    const int64_t rows = ids.size(0);
+    const int64_t cols = ids.size(1);
+    const auto *data = ids.data_ptr<int64_t>();
+    std::vector<std::vector<uint32_t>> out(static_cast<size_t>(rows));
+    for (int64_t r = 0; r < rows; ++r)
+      out[static_cast<size_t>(r)].assign(data + r * cols, data + (r + 1) * cols);
+    return out;
+  }
+
+  struct StepOutput {
+    torch::Tensor logits;  // {beams, vocab} for the newest position
+    torch::Tensor selfKv;  // {layers, 2, beams, heads, steps, headDim}
+    torch::Tensor crossKv; // {layers, 2, beams, heads, patches, headDim}
+  };
+
+  static StepOutput decodeFirst(torch::jit::Module &module,
+                                const torch::Tensor &ids,
+                                const torch::Tensor &encoded) {
+    auto out = module.get_method("decode_first")({ids, encoded}).toTuple();
+    return {out->elements()[0].toTensor(), out->elements()[1].toTensor(),
+            out->elements()[2].toTensor()};
+  }
+
+  static void decodeNext(torch::jit::Module &module, const torch::Tensor &ids,
+                         const torch::Tensor &encoded, StepOutput &state) {
+    auto out = module.get_method("decode_next")({ids, encoded, state.selfKv,
+                                                 state.crossKv})
+                   .toTuple();
+    state.logits = out->elements()[0].toTensor();
+    state.selfKv = out->elements()[1].toTensor();
+  }
+
+  static std::vector<std::vector<uint32_t>>
+  generate(torch::jit::Module &module, const torch::Tensor &input,
+           const GenerationConfig &config, const std::atomic<bool> *cancel) {
+    torch::Tensor encoded = module.get_method("encode")({input}).toTensor();
+    if (isCancelled(cancel))
+      return {};
+    if (config.numBeams <= 1)
+      return greedy(module, encoded, config, cancel);
+    // Beams already widen the batch, so glyphs are searched one at a time.
+    std::vector<std::vector<uint32_t>> out;
+    for (int64_t i = 0; i < encoded.size(0); ++i) {
+      out.push_back(beamSearch(module, encoded.narrow(0, i, 1), config, cancel));
+      if (isCancelled(cancel))
+        return {};
+    }
+    return out;
+  }
+
+  // Greedy decoding of a whole batch. Rows that reach EOS keep being fed
+  // EOS until every row is done; their extra outputs are ignored.
+  static std::vector<std::vector<uint32_t>>
+  greedy(torch::jit::Module &module, const torch::Tensor &encoded,
+         const GenerationConfig &config, const std::atomic<bool> *cancel) {
+    const int64_t batch = encoded.size(0);
+    std::vector<std::vector<int64_t>> tokens(static_cast<size_t>(batch));
+    std::vector<char> done(static_cast<size_t>(batch), 0);
+    int64_t remaining = batch;
+    torch::Tensor ids =
+        torch::full({batch, 1}, config.startToken, torch::kLong);
+    StepOutput state = decodeFirst(module, ids, encoded);
+    for (;;) {
+      if (isCancelled(cancel))
+        return {};
+      torch::Tensor next = state.logits.argmax(-1).to(torch::kCPU).contiguous();
+      const int64_t *nextData = next.data_ptr<int64_t>();
+      std::vector<int64_t> feed(static_cast<size_t>(batch), config.eosToken);
+      for (int64_t b = 0; b < batch; ++b) {
+        const size_t row = static_cast<size_t>(b);
+        if (done[row])
+          continue;
+        if (nextData[b] == config.eosToken) {
+          done[row] = 1;
+          --remaining;
+          continue;
+        }
+        tokens[row].push_back(nextData[b]);
+        feed[row] = nextData[b];
+        if (static_cast<int>(tokens[row].size()) >= config.maxLength) {
+          done[row] = 1;
+          --remaining;
+        }
+      }
+      if (remaining == 0)
+        break;
+      ids = torch::tensor(feed).view({batch, 1});
+      decodeNext(module, ids, encoded, state);
+    }
+    std::vector<std::vector<uint32_t>> out;
+    out.reserve(tokens.size());
+    for (const auto &row : tokens)
+      out.push_back(toTokenIds(row));
+    return out;
+  }
+
+  // Small beam search with length-normalized scores. Each step scores every
+  // (beam, token) pair, keeps the best 2*beams candidates, retires those
+  // ending in EOS and continues the rest; the cache is reordered to follow
+  // the surviving beams.
+  static std::vector<uint32_t> beamSearch(torch::jit::Module &module,
+                                          const torch::Tensor &encoded,
+                                          const GenerationConfig &config,
+                                          const std::atomic<bool> *cancel) {
+    const int beams = config.numBeams;
+    torch::Tensor ids = torch::full({1, 1}, config.startToken, torch::kLong);
+    StepOutput state = decodeFirst(module, ids, encoded);
+    torch::Tensor beamEncoded = encoded;
+    std::vector<std::vector<int64_t>> live{{}};
+    std::vector<float> liveScores{0.f};
+    std::vector<std::pair<float, std::vector<int64_t>>> finished;
+    // Mean log-probability per scored token. A finished beam also scored
+    // its EOS; a live one only the tokens it holds.
+    auto normalized = [](float score, size_t scoredTokens) {
+      return score / static_cast<float>(scoredTokens);
+    };
+
+    for (int step = 0; step < config.maxLength; ++step) {
+      if (isCancelled(cancel))
+        return {};
+      torch::Tensor logProbs =
+          torch::log_softmax(state.logits.to(torch::kFloat32), -1);
+      const int64_t vocab = logProbs.size(1);
+      torch::Tensor total =
+          logProbs + torch::tensor(liveScores).unsqueeze(1);
+      const int64_t candidates =
+          std::min<int64_t>(2 * beams, total.numel());
+      auto top = total.view({-1}).topk(candidates);
+      torch::Tensor values = std::get<0>(top).contiguous();
+      torch::Tensor indices = std::get<1>(top).contiguous();
+      const float *valueData = values.data_ptr<float>();
+      const int64_t *indexData = indices.data_ptr<int64_t>();
+
+      std::vector<std::vector<int64_t>> nextLive;
+      std::vector<float> nextScores;
+      std::vector<int64_t> parents;
+      for (int64_t c = 0; c < candidates; ++c) {
+        const int64_t parent = indexData[c] / vocab;
+        const int64_t token = indexData[c] % vocab;
+        std::vector<int64_t> seq = live[static_cast<size_t>(parent)];
+        if (token == config.eosToken) {
+          finished.emplace_back(normalized(valueData[c], seq.size() + 1),
+                                std::move(seq));
+        } else if (static_cast<int>(nextLive.size()) < beams) {
+          seq.push_back(token);
+          nextLive.push_back(std::move(seq));
+          nextScores.push_back(valueData[c]);
+          parents.push_back(parent);
+        }
+      }
+      if (static_cast<int>(finished.size()) >= beams || nextLive.empty())
+        break;
+      live = std::move(nextLive);
+      liveScores = std::move(nextScores);
+      if (step + 1 == config.maxLength)
+        break;
+
+      const int64_t width = static_cast<int64_t>(live.size());
+      if (beamEncoded.size(0) != width) {
+        torch::Tensor first = torch::zeros({width}, torch::kLong);
+        beamEncoded = encoded.index_select(0, first);
+        state.crossKv = state.crossKv.index_select(
+            2, torch::zeros({width}, torch::kLong));
+      }
+      state.selfKv = state.selfKv.index_select(2, torch::tensor(parents));
+      std::vector<int64_t> last;
+      last.reserve(live.size());
+      for (const auto &seq : live)
+        last.push_back(seq.back());
+      ids = torch::tensor(last).view({width, 1});
+      decodeNext(module, ids, beamEncoded, state);
+    }
+    for (size_t i = 0; i < live.size(); ++i) {
+      if (!live[i].empty())
+        finished.emplace_back(normalized(liveScores[i], live[i].size()),
+                              live[i]);
+    }
+    if (finished.empty())
+      return {};
+    auto best = std::max_element(
+        finished.begin(), finished.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+    return toTokenIds(best->second);
+  }
+
+  // `configured` threads, or the cores shared between `decodes` decodes.
+  static int intraOpThreadsFor(int configured, size_t decodes) {
+    if (configured > 0)
+      return configured;
+    const int cores =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    return std::max(1, cores / static_cast<int>(std::max<size_t>(1, decodes)));
+  }
+
+  // Runs on the decoding thread once it holds a replica. OpenMP's thread
+  // count belongs to the calling thread, so this neither caps other decodes
+  // nor other LibTorch users in the process.
+  static void useIntraOpThreads(int configured, size_t concurrent) {
+#if AT_PARALLEL_OPENMP
+    const int threads = intraOpThreadsFor(configured, concurrent);
+    if (at::get_num_threads() != threads)
+      at::set_num_threads(threads);
+#else
+    (void)configured;
+    (void)concurrent;
+#endif
+  }
+
+  // Process-wide settings, applied when the module loads: the inter-op
+  // pool and, in native thread-pool builds, the single intra-op pool.
+  void applyThreadSettings() {
+    if (m_threadsApplied)
+      return;
+#if !AT_PARALLEL_OPENMP
+    at::set_num_threads(
+        intraOpThreadsFor(m_intraOpThreads, static_cast<size_t>(replicaCount())));
+#endif
+    if (m_interOpThreads > 0 && at::get_num_interop_threads() != m_interOpThreads) {
+      try {
+        at::set_num_interop_threads(m_interOpThreads);
+      } catch (const c10::Error &err) {
+        SC_LOG(sc::LogLevel::Warn,
+               std::string("Cannot change TrOCR inter-op threads: ") +
+                   err.what_without_backtrace());
+      }
+    }
+    m_threadsApplied = true;
+  }
+
+  // The generator's entry points and the token ids read from it must
+  // survive freezing, which otherwise inlines and drops them.
+  static torch::jit::Module optimizeModule(const torch::jit::Module &module,
+                                           bool incremental) {
+    std::vector<std::string> methods;
+    std::vector<std::string> preserved;
+    if (incremental) {
+      methods = {"encode", "decode_first", "decode_next"};
+      preserved = methods;
+      preserved.push_back("decoder_start_token_id");
+      preserved.push_back("eos_token_id");
+    }
+    torch::jit::Module frozen = torch::jit::freeze(module, preserved);
+    return torch::jit::optimize_for_inference(frozen, methods);
+  }
+
   bool ensureLoaded() {
+    applyThreadSettings();
     if (!m_moduleLoaded) {
       if (m_modelPath.empty())
         return false;
       try {
         auto module = torch::jit::load(m_modelPath);
+        module.eval();
+        m_generation = GenerationConfig();
+        m_generation.incremental = module.find_method("encode").has_value() &&
+                                   module.find_method("decode_first").has_value() &&
+                                   module.find_method("decode_next").has_value();
+        if (m_generation.incremental) {
+          if (module.hasattr("decoder_start_token_id"))
+            m_generation.startToken =
+                module.attr("decoder_start_token_id").toInt();
+          if (module.hasattr("eos_token_id"))
+            m_generation.eosToken = module.attr("eos_token_id").toInt();
+        }
+        if (m_optimizeOnLoad) {
+          try {
+            module = optimizeModule(module, m_generation.incremental);
+          } catch (const c10::Error &err) {
+            SC_LOG(sc::LogLevel::Warn,
+                   std::string("TrOCR module left unoptimized: ") +
+                       err.what_without_backtrace());
+          }
+        }
         m_module = std::make_shared<torch::jit::Module>(std::move(module));
         m_moduleLoaded = true;
       } catch (const c10::Error &err) {
@@ -143,6 +808,20 @@ private:
       }
     }
     if (!m_tokenizerLoaded) {
+      // The precomputed table decodes ids with array lookups; the tokenizer
+      // is only loaded when no table is configured or it cannot be read.
+      m_tokens.reset();
+      m_tokenizer.reset();
+      if (!m_tokenTablePath.empty()) {
+        auto tokens = std::make_shared<TokenTable>();
+        if (tokens->load(m_tokenTablePath)) {
+          m_tokens = std::move(tokens);
+          m_tokenizerLoaded = true;
+          return m_moduleLoaded;
+        }
+        SC_LOG(sc::LogLevel::Warn, "TrOCR token table " + m_tokenTablePath +
+                                       " is unusable; falling back to the tokenizer.");
+      }
       if (m_tokenizerPath.empty())
         return false;
       try {
@@ -163,16 +842,37 @@ private:
 
   std::shared_ptr<torch::jit::Module> m_module;
   std::shared_ptr<tokenizers::Tokenizer> m_tokenizer;
+#endif
+#ifdef SC_USE_ONNXRUNTIME
+  std::shared_ptr<const TrocrOnnxModel> m_onnx;
+#endif
+  std::shared_ptr<const TokenTable> m_tokens;
+
+  Backend m_backend{Backend::Torch};
   bool m_moduleLoaded{false};
   bool m_tokenizerLoaded{false};
-#else
-  bool ensureLoaded() { return false; }
-#endif
+  GenerationConfig m_generation;
+  int m_maxLength{16};
+  int m_numBeams{1};
+  bool m_threadsApplied{false};
 
   std::string m_modelPath;
   std::string m_tokenizerPath;
+  std::string m_tokenTablePath;
   int m_inputSize{384};
+  int m_intraOpThreads{0};
+  int m_interOpThreads{0};
+  bool m_optimizeOnLoad{false};
+  // Guards configuration and the loaded module/tokenizer pointers.
   mutable std::mutex m_mutex;
+  // Guards the replica pool.
+  mutable std::mutex m_poolMutex;
+  std::condition_variable m_poolCv;
+  std::vector<std::unique_ptr<Replica>> m_idle;
+  size_t m_replicaCount{1};
+  size_t m_busy{0};
+  // The tokenizer is not documented as thread-safe; decoding ids is cheap.
+  std::mutex m_tokenizerMutex;
 };
 
 } // namespace sc
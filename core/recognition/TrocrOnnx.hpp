@@ -0,0 +1,347 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef SC_USE_ONNXRUNTIME
+#  include "OrtEnvironment.hpp"
+#  include "utils/Logger.hpp"
+#  include "utils/MappedFile.hpp"
+#endif
+
+namespace sc {
+
+// How a TrOCR decode generates tokens; shared by both decoder backends.
+struct TrocrGenerationConfig {
+    bool incremental{false};
+    int64_t startToken{2};
+    int64_t eosToken{2};
+    int maxLength{16};
+    int numBeams{1};
+};
+
+inline bool trocrCancelled(const std::atomic<bool>* cancel) {
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+#ifdef SC_USE_ONNXRUNTIME
+// ONNX Runtime version of the incremental TrOCR generator. A model directory
+// written by scripts/export_trocr.py --onnx holds three graphs with the same
+// contract as the TorchScript generator's methods:
+//
+//   encoder.onnx        pixel_values {B,3,H,W} -> encoded {B,patches,dim}
+//   decoder_first.onnx  input_ids {B,1}, encoded -> logits {B,vocab},
+//                       self_kv, cross_kv
+//   decoder_next.onnx   input_ids {B,1}, encoded, self_kv, cross_kv
+//                       -> logits {B,vocab}, next_self_kv
+//
+// with caches laid out as {layers, 2, B, heads, len, headDim}. Sessions run on
+// the shared environment and thread pools from OrtEnvironment.hpp, and
+// Session::Run is thread-safe, so one instance serves every decoder replica.
+class TrocrOnnxModel {
+public:
+    bool load(const std::string& dir) {
+        return loadGraph(dir + "/encoder.onnx", m_encoder) &&
+               loadGraph(dir + "/decoder_first.onnx", m_first) &&
+               loadGraph(dir + "/decoder_next.onnx", m_next);
+    }
+
+    // `pixels` holds `batch` normalized {3,height,width} images. Returns the
+    // generated token ids per image (without start/EOS), or an empty vector
+    // if cancelled.
+    std::vector<std::vector<uint32_t>> generate(const float* pixels, int64_t batch, int64_t height,
+                                                int64_t width, const TrocrGenerationConfig& config,
+                                                const std::atomic<bool>* cancel) const {
+        const int64_t shape[4] = {batch, 3, height, width};
+        Ort::Value input = Ort::Value::CreateTensor<float>(
+            cpuMemory(), const_cast<float*>(pixels), static_cast<size_t>(batch * 3 * height * width),
+            shape, 4);
+        static const char* const kInputs[] = {"pixel_values"};
+        static const char* const kOutputs[] = {"encoded"};
+        auto out = m_encoder->Run(Ort::RunOptions{nullptr}, kInputs, &input, 1, kOutputs, 1);
+        Ort::Value encoded = std::move(out[0]);
+        if (trocrCancelled(cancel))
+            return {};
+        if (config.numBeams <= 1)
+            return greedy(encoded, batch, config, cancel);
+        // Beams already widen the batch, so images are searched one at a time.
+        std::vector<std::vector<uint32_t>> results;
+        for (int64_t i = 0; i < batch; ++i) {
+            Ort::Value row = rows(encoded, i, 1);
+            results.push_back(beamSearch(row, config, cancel));
+            if (trocrCancelled(cancel))
+                return {};
+        }
+        return results;
+    }
+
+private:
+    struct Step {
+        Ort::Value logits{nullptr};  // {B, vocab}
+        Ort::Value selfKv{nullptr};  // {layers, 2, B, heads, steps, headDim}
+        Ort::Value crossKv{nullptr}; // {layers, 2, B, heads, patches, headDim}
+    };
+
+    static bool loadGraph(const std::string& path, std::shared_ptr<Ort::Session>& session) {
+        MappedFile file(path);
+        if (!file.valid()) {
+            SC_LOG(sc::LogLevel::Error, "TrOCR graph " + path + " is missing.");
+            return false;
+        }
+        try {
+            session = std::make_shared<Ort::Session>(ortEnv(), file.data(), file.size(),
+                                                     ortSessionOptions(), ortPrepackedWeights());
+        } catch (const Ort::Exception& e) {
+            SC_LOG(sc::LogLevel::Error, "ONNX Runtime could not load " + path + ": " + e.what());
+            return false;
+        } catch (...) {
+            SC_LOG(sc::LogLevel::Error, "ONNX Runtime could not load " + path);
+            return false;
+        }
+        return true;
+    }
+
+    static const Ort::MemoryInfo& cpuMemory() {
+        static const Ort::MemoryInfo info =
+            Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        return info;
+    }
+
+    static std::vector<int64_t> shapeOf(const Ort::Value& value) {
+        return value.GetTensorTypeAndShapeInfo().GetShape();
+    }
+
+    // A non-owning view of `count` rows of a {B,...} tensor starting at
+    // `first`. Run() takes a contiguous array of values, so cached tensors
+    // are passed as views rather than moved in.
+    static Ort::Value rows(const Ort::Value& value, int64_t first, int64_t count) {
+        std::vector<int64_t> shape = shapeOf(value);
+        size_t rowSize = 1;
+        for (size_t d = 1; d < shape.size(); ++d)
+            rowSize *= static_cast<size_t>(shape[d]);
+        shape[0] = count;
+        float* data = const_cast<float*>(value.GetTensorData<float>()) + first * rowSize;
+        return Ort::Value::CreateTensor<float>(cpuMemory(), data, rowSize * static_cast<size_t>(count),
+                                               shape.data(), shape.size());
+    }
+
+    static Ort::Value view(const Ort::Value& value) { return rows(value, 0, shapeOf(value)[0]); }
+
+    // Copies a cache with its batch axis (2) reordered to `beams`.
+    static Ort::Value gatherBatch(const Ort::Value& cache, const std::vector<int64_t>& beams) {
+        std::vector<int64_t> shape = shapeOf(cache);
+        const size_t outer = static_cast<size_t>(shape[0] * shape[1]);
+        const size_t oldBatch = static_cast<size_t>(shape[2]);
+        size_t inner = 1;
+        for (size_t d = 3; d < shape.size(); ++d)
+            inner *= static_cast<size_t>(shape[d]);
+        shape[2] = static_cast<int64_t>(beams.size());
+        Ort::AllocatorWithDefaultOptions allocator;
+        Ort::Value out = Ort::Value::CreateTensor<float>(allocator, shape.data(), shape.size());
+        const float* src = cache.GetTensorData<float>();
+        float* dst = out.GetTensorMutableData<float>();
+        for (size_t o = 0; o < outer; ++o) {
+            for (size_t b = 0; b < beams.size(); ++b) {
+                std::copy_n(src + (o * oldBatch + static_cast<size_t>(beams[b])) * inner, inner,
+                            dst + (o * beams.size() + b) * inner);
+            }
+        }
+        return out;
+    }
+
+    static Ort::Value tokenIds(std::vector<int64_t>& ids) {
+        const int64_t shape[2] = {static_cast<int64_t>(ids.size()), 1};
+        return Ort::Value::CreateTensor<int64_t>(cpuMemory(), ids.data(), ids.size(), shape, 2);
+    }
+
+    Step decodeFirst(std::vector<int64_t>& ids, const Ort::Value& encoded) const {
+        static const char* const kInputs[] = {"input_ids", "encoded"};
+        static const char* const kOutputs[] = {"logits", "self_kv", "cross_kv"};
+        Ort::Value inputs[] = {tokenIds(ids), view(encoded)};
+        auto out = m_first->Run(Ort::RunOptions{nullptr}, kInputs, inputs, 2, kOutputs, 3);
+        Step step;
+        step.logits = std::move(out[0]);
+        step.selfKv = std::move(out[1]);
+        step.crossKv = std::move(out[2]);
+        return step;
+    }
+
+    void decodeNext(std::vector<int64_t>& ids, const Ort::Value& encoded, Step& step) const {
+        static const char* const kInputs[] = {"input_ids", "encoded", "self_kv", "cross_kv"};
+        static const char* const kOutputs[] = {"logits", "next_self_kv"};
+        Ort::Value inputs[] = {tokenIds(ids), view(encoded), view(step.selfKv), view(step.crossKv)};
+        auto out = m_next->Run(Ort::RunOptions{nullptr}, kInputs, inputs, 4, kOutputs, 2);
+        step.logits = std::move(out[0]);
+        step.selfKv = std::move(out[1]);
+    }
+
+    // Batched greedy decoding; rows that reach EOS keep being fed EOS until
+    // every row is done, as in TrocrDecoder's LibTorch path.
+    std::vector<std::vector<uint32_t>> greedy(const Ort::Value& encoded, int64_t batch,
+                                              const TrocrGenerationConfig& config,
+                                              const std::atomic<bool>* cancel) const {
+        std::vector<std::vector<uint32_t>> tokens(static_cast<size_t>(batch));
+        std::vector<char> done(static_cast<size_t>(batch), 0);
+        int64_t remaining = batch;
+        std::vector<int64_t> feed(static_cast<size_t>(batch), config.startToken);
+        Step step = decodeFirst(feed, encoded);
+        for (;;) {
+            if (trocrCancelled(cancel))
+                return {};
+            const int64_t vocab = shapeOf(step.logits)[1];
+            const float* logits = step.logits.GetTensorData<float>();
+            for (int64_t b = 0; b < batch; ++b) {
+                const size_t row = static_cast<size_t>(b);
+                feed[row] = config.eosToken;
+                if (done[row])
+                    continue;
+                const float* rowLogits = logits + b * vocab;
+                const int64_t next = std::max_element(rowLogits, rowLogits + vocab) - rowLogits;
+                if (next == config.eosToken) {
+                    done[row] = 1;
+                    --remaining;
+                    continue;
+                }
+                tokens[row].push_back(static_cast<uint32_t>(next));
+                feed[row] = next;
+                if (static_cast<int>(tokens[row].size()) >= config.maxLength) {
+                    done[row] = 1;
+                    --remaining;
+                }
+            }
+            if (remaining == 0)
+                break;
+            decodeNext(feed, encoded, step);
+        }
+        return tokens;
+    }
+
+    // Same length-normalized beam search as the LibTorch path: each step
+    // keeps the best 2*beams (beam, token) candidates, retires those ending
+    // in EOS and continues the rest with the caches reordered to follow them.
+    std::vector<uint32_t> beamSearch(const Ort::Value& encoded, const TrocrGenerationConfig& config,
+                                     const std::atomic<bool>* cancel) const {
+        const int beams = config.numBeams;
+        std::vector<int64_t> feed{config.startToken};
+        Step step = decodeFirst(feed, encoded);
+        Ort::Value beamEncoded = view(encoded);
+        std::vector<std::vector<uint32_t>> live{{}};
+        std::vector<float> liveScores{0.f};
+        std::vector<std::pair<float, std::vector<uint32_t>>> finished;
+        // Mean log-probability per scored token, as in the LibTorch path.
+        auto normalized = [](float score, size_t scoredTokens) {
+            return score / static_cast<float>(scoredTokens);
+        };
+        struct Candidate {
+            float score;
+            int64_t parent;
+            int64_t token;
+        };
+        const size_t keep = static_cast<size_t>(2 * beams);
+        std::vector<int64_t> order;
+
+        for (int iteration = 0; iteration < config.maxLength; ++iteration) {
+            if (trocrCancelled(cancel))
+                return {};
+            const int64_t vocab = shapeOf(step.logits)[1];
+            const float* logits = step.logits.GetTensorData<float>();
+            // The best 2*beams candidates overall are among each beam's own
+            // best 2*beams tokens.
+            std::vector<Candidate> candidates;
+            for (size_t b = 0; b < live.size(); ++b) {
+                const float* row = logits + static_cast<int64_t>(b) * vocab;
+                const float peak = *std::max_element(row, row + vocab);
+                double sum = 0.0;
+                for (int64_t v = 0; v < vocab; ++v)
+                    sum += std::exp(static_cast<double>(row[v] - peak));
+                const float logNorm = peak + static_cast<float>(std::log(sum));
+                order.resize(static_cast<size_t>(vocab));
+                for (int64_t v = 0; v < vocab; ++v)
+                    order[static_cast<size_t>(v)] = v;
+                const size_t top = std::min(keep, order.size());
+                std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(top),
+                                  order.end(),
+                                  [row](int64_t a, int64_t c) { return row[a] > row[c]; });
+                for (size_t k = 0; k < top; ++k) {
+                    const int64_t token = order[k];
+                    candidates.push_back(
+                        {liveScores[b] + row[token] - logNorm, static_cast<int64_t>(b), token});
+                }
+            }
+            const size_t top = std::min(keep, candidates.size());
+            std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(top),
+                              candidates.end(),
+                              [](const Candidate& a, const Candidate& c) { return a.score > c.score; });
+
+            std::vector<std::vector<uint32_t>> nextLive;
+            std::vector<float> nextScores;
+            std::vector<int64_t> parents;
+            for (size_t c = 0; c < top; ++c) {
+                std::vector<uint32_t> seq = live[static_cast<size_t>(candidates[c].parent)];
+                if (candidates[c].token == config.eosToken) {
+                    finished.emplace_back(normalized(candidates[c].score, seq.size() + 1),
+                                          std::move(seq));
+                } else if (static_cast<int>(nextLive.size()) < beams) {
+                    seq.push_back(static_cast<uint32_t>(candidates[c].token));
+                    nextLive.push_back(std::move(seq));
+                    nextScores.push_back(candidates[c].score);
+                    parents.push_back(candidates[c].parent);
+                }
+            }
+            if (static_cast<int>(finished.size()) >= beams || nextLive.empty())
+                break;
+            live = std::move(nextLive);
+            liveScores = std::move(nextScores);
+            if (iteration + 1 == config.maxLength)
+                break;
+
+            const int64_t width = static_cast<int64_t>(live.size());
+            if (shapeOf(beamEncoded)[0] != width) {
+                const std::vector<int64_t> first(static_cast<size_t>(width), 0);
+                beamEncoded = repeatRow(encoded, width);
+                step.crossKv = gatherBatch(step.crossKv, first);
+            }
+            step.selfKv = gatherBatch(step.selfKv, parents);
+            feed.clear();
+            for (const auto& seq : live)
+                feed.push_back(static_cast<int64_t>(seq.back()));
+            decodeNext(feed, beamEncoded, step);
+        }
+        for (size_t i = 0; i < live.size(); ++i) {
+            if (!live[i].empty())
+                finished.emplace_back(normalized(liveScores[i], live[i].size()), live[i]);
+        }
+        if (finished.empty())
+            return {};
+        auto best = std::max_element(finished.begin(), finished.end(),
+                                     [](const auto& a, const auto& b) { return a.first < b.first; });
+        return best->second;
+    }
+
+    // Copies a {1,...} tensor into `count` identical rows.
+    static Ort::Value repeatRow(const Ort::Value& value, int64_t count) {
+        std::vector<int64_t> shape = shapeOf(value);
+        size_t rowSize = 1;
+        for (size_t d = 1; d < shape.size(); ++d)
+            rowSize *= static_cast<size_t>(shape[d]);
+        shape[0] = count;
+        Ort::AllocatorWithDefaultOptions allocator;
+        Ort::Value out = Ort::Value::CreateTensor<float>(allocator, shape.data(), shape.size());
+        const float* src = value.GetTensorData<float>();
+        float* dst = out.GetTensorMutableData<float>();
+        for (int64_t r = 0; r < count; ++r)
+            std::copy_n(src, rowSize, dst + static_cast<size_t>(r) * rowSize);
+        return out;
+    }
+
+    std::shared_ptr<Ort::Session> m_encoder;
+    std::shared_ptr<Ort::Session> m_first;
+    std::shared_ptr<Ort::Session> m_next;
+};
+#endif
+
+} // namespace sc
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Compare exported TrOCR modules for latency and accuracy on a fixed glyph set.
+
+Each ``--module`` is a ``name=path`` pair; the first one is the baseline the
+others are compared against. Typical use after exporting the variants with
+scripts/export_trocr.py:
+
+    python scripts/eval_trocr.py --glyphs glyphs/manifest.tsv \\
+        --module fp32=models/trocr_generator.pt \\
+        --module fp32+opt=models/trocr_generator.pt:optimize \\
+        --module int8=models/trocr_generator_int8.pt
+
+A ``:optimize`` suffix freezes and optimizes the module after loading, like
+``"optimize_on_load"`` in config/trocr.json. The glyph manifest has one
+``<image path>\\t<expected text>`` per line (paths relative to the manifest);
+``--synthesize DIR`` writes a deterministic set rendered from a font.
+"""
+import argparse
+import os
+import statistics
+import time
+
+import torch
+from PIL import Image, ImageDraw, ImageFont
+from transformers import TrOCRProcessor
+
+from export_trocr import greedy, optimize_generator
+
+DEFAULT_CHARSET = "0123456789ABCDEFGHJKLMNPQRSTUVWXYZabdefghnqrt+-=*/<>()[]{}#%&?"
+
+
+def synthesize(out_dir, font_path, size, variants):
+    """Render each charset glyph at a few fixed offsets and rotations."""
+    os.makedirs(out_dir, exist_ok=True)
+    try:
+        font = ImageFont.truetype(font_path or "DejaVuSans.ttf", int(size * 0.6))
+    except OSError:
+        font = ImageFont.load_default()
+    lines = []
+    for index, char in enumerate(DEFAULT_CHARSET):
+        for variant in range(variants):
+            image = Image.new("RGB", (size, size), "white")
+            draw = ImageDraw.Draw(image)
+            offset = (variant - variants // 2) * size // 24
+            draw.text((size // 4 + offset, size // 6 - offset), char, fill="black", font=font)
+            image = image.rotate((variant - variants // 2) * 4, fillcolor="white")
+            name = f"glyph_{index:03d}_{variant}.png"
+            image.save(os.path.join(out_dir, name))
+            lines.append(f"{name}\t{char}")
+    manifest = os.path.join(out_dir, "manifest.tsv")
+    with open(manifest, "w", encoding="utf-8") as handle:
+        handle.write("\n".join(lines) + "\n")
+    return manifest
+
+
+def load_glyphs(manifest):
+    base = os.path.dirname(os.path.abspath(manifest))
+    glyphs = []
+    with open(manifest, encoding="utf-8") as handle:
+        for line in handle:
+            line = line.rstrip("\n")
+            if not line or line.startswith("#"):
+                continue
+            path, _, label = line.partition("\t")
+            glyphs.append((os.path.join(base, path), label))
+    return glyphs
+
+
+def edit_distance(a, b):
+    row = list(range(len(b) + 1))
+    for i, ca in enumerate(a, 1):
+        prev, row[0] = row[0], i
+        for j, cb in enumerate(b, 1):
+            prev, row[j] = row[j], min(row[j] + 1, row[j - 1] + 1, prev + (ca != cb))
+    return row[len(b)]
+
+
+def load_module(spec):
+    optimize = spec.endswith(":optimize")
+    path = spec[:-len(":optimize")] if optimize else spec
+    module = torch.jit.load(path).eval()
+    return optimize_generator(module) if optimize else module
+
+
+def run(module, pixel_values, max_length):
+    if hasattr(module, "decode_first"):
+        return greedy(module, pixel_values, max_length)
+    return module(pixel_values).argmax(-1)[0].tolist()
+
+
+def evaluate(module, inputs, tokenizer, max_length, warmup):
+    with torch.no_grad():
+        for pixel_values, _ in inputs[:warmup]:
+            run(module, pixel_values, max_length)
+        latencies, exact, errors, chars = [], 0, 0, 0
+        for pixel_values, label in inputs:
+            start = time.perf_counter()
+            tokens = run(module, pixel_values, max_length)
+            latencies.append((time.perf_counter() - start) * 1000.0)
+            text = tokenizer.decode(tokens, skip_special_tokens=True).strip()
+            exact += text == label
+            errors += edit_distance(text, label)
+            chars += max(1, len(label))
+    latencies.sort()
+    return {
+        "mean": statistics.fmean(latencies),
+        "p50": latencies[len(latencies) // 2],
+        "p95": latencies[min(len(latencies) - 1, int(len(latencies) * 0.95))],
+        "accuracy": exact / len(inputs),
+        "cer": errors / chars,
+    }
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Compare TrOCR module variants")
+    parser.add_argument("--module", action="append", required=True,
+                        help="name=path[:optimize]; the first is the baseline")
+    parser.add_argument("--processor_dir", default="./trocr_processor")
+    parser.add_argument("--glyphs", help="Manifest of <image>\\t<text> lines")
+    parser.add_argument("--synthesize", metavar="DIR",
+                        help="Render the built-in glyph set into DIR and evaluate on it")
+    parser.add_argument("--font", help="TrueType font used by --synthesize")
+    parser.add_argument("--variants", type=int, default=3, help="Renderings per glyph")
+    parser.add_argument("--size", type=int, default=384)
+    parser.add_argument("--max_length", type=int, default=16)
+    parser.add_argument("--threads", type=int, default=0, help="Intra-op threads (0 = default)")
+    parser.add_argument("--inter_op_threads", type=int, default=0)
+    parser.add_argument("--warmup", type=int, default=3)
+    args = parser.parse_args()
+
+    if args.inter_op_threads > 0:
+        torch.set_num_interop_threads(args.inter_op_threads)
+    if args.threads > 0:
+        torch.set_num_threads(args.threads)
+
+    manifest = args.glyphs
+    if args.synthesize:
+        manifest = synthesize(args.synthesize, args.font, args.size, args.variants)
+    if not manifest:
+        raise SystemExit("Pass --glyphs or --synthesize")
+
+    processor = TrOCRProcessor.from_pretrained(args.processor_dir)
+    inputs = []
+    for path, label in load_glyphs(manifest):
+        image = Image.open(path).convert("RGB")
+        inputs.append((processor(images=image, return_tensors="pt").pixel_values, label))
+    if not inputs:
+        raise SystemExit(f"No glyphs listed in {manifest}")
+
+    print(f"{len(inputs)} glyphs, {torch.get_num_threads()} intra-op threads")
+    print(f"{'variant':<16}{'mean ms':>10}{'p50 ms':>10}{'p95 ms':>10}"
+          f"{'exact':>9}{'CER':>8}{'speedup':>9}")
+    baseline = None
+    for entry in args.module:
+        name, _, spec = entry.partition("=")
+        if not spec:
+            raise SystemExit(f"Expected name=path, got '{entry}'")
+        result = evaluate(load_module(spec), inputs, processor.tokenizer,
+                          args.max_length, args.warmup)
+        baseline = baseline or result
+        print(f"{name:<16}{result['mean']:>10.2f}{result['p50']:>10.2f}{result['p95']:>10.2f}"
+              f"{result['accuracy']:>9.1%}{result['cer']:>8.3f}"
+              f"{baseline['mean'] / result['mean']:>8.2f}x")
+
+
+if __name__ == "__main__":
+    main()
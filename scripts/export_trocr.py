@@ -1,24 +1,356 @@
 #!/usr/bin/env python3
-"""Export a TrOCR model to TorchScript for C++ inference."""
-from transformers import TrOCRProcessor, VisionEncoderDecoderModel
+"""Export a TrOCR model to TorchScript for C++ inference.
+
+By default the model is exported as an incremental generator: a scripted
+module with ``encode``, ``decode_first`` and ``decode_next`` methods that
+core/recognition/TrocrDecoder.hpp steps token by token, reusing the encoder
+output and the decoder's key/value cache. ``--legacy`` writes the old
+single-pass traced model instead.
+
+``--quantize`` applies dynamic int8 quantization to the model's linear layers
+before export, and ``--optimize`` freezes the scripted generator and runs
+``optimize_for_inference`` on it. Compare the variants with
+scripts/eval_trocr.py before switching config/trocr.json to one of them.
+
+``--onnx DIR`` writes the same three entry points as ONNX graphs
+(encoder.onnx, decoder_first.onnx, decoder_next.onnx) plus tokens.bin, the
+vocabulary table read by core/recognition/TokenTable.hpp, for the decoder's
+ONNX Runtime backend. TorchScript exports write the same table to
+``--processor_dir`` so the LibTorch backend can decode without the tokenizer.
+"""
+import argparse
+import os
+import struct
+from typing import Tuple
+
 import torch
 from PIL import Image
+from transformers import TrOCRProcessor, VisionEncoderDecoderModel
+
+
+def legacy_cache(past):
+    """Per-layer (self_k, self_v, cross_k, cross_v) tuples."""
+    return past.to_legacy_cache() if hasattr(past, "to_legacy_cache") else past
+
+
+def model_cache(layers):
+    try:
+        from transformers.cache_utils import EncoderDecoderCache
+    except ImportError:
+        return layers
+    return EncoderDecoderCache.from_legacy_cache(layers)
+
+
+def stack_cache(past):
+    """Stack the cache into {layers, 2, batch, heads, len, head_dim} tensors."""
+    layers = legacy_cache(past)
+    self_kv = torch.stack([torch.stack([layer[0], layer[1]]) for layer in layers])
+    cross_kv = torch.stack([torch.stack([layer[2], layer[3]]) for layer in layers])
+    return self_kv, cross_kv
+
+
+def unstack_cache(self_kv, cross_kv):
+    return tuple(
+        (self_kv[i, 0], self_kv[i, 1], cross_kv[i, 0], cross_kv[i, 1])
+        for i in range(self_kv.shape[0])
+    )
+
+
+class Encoder(torch.nn.Module):
+    def __init__(self, model):
+        super().__init__()
+        self.encoder = model.encoder
+        # VisionEncoderDecoderModel only has this projection when the encoder
+        # and decoder widths differ, and applies it before cross-attention.
+        self.proj = getattr(model, "enc_to_dec_proj", None)
+
+    def forward(self, pixel_values):
+        hidden = self.encoder(pixel_values=pixel_values).last_hidden_state
+        return self.proj(hidden) if self.proj is not None else hidden
+
+
+class DecoderFirst(torch.nn.Module):
+    def __init__(self, model):
+        super().__init__()
+        self.decoder = model.decoder
+
+    def forward(self, input_ids, encoded):
+        out = self.decoder(input_ids=input_ids, encoder_hidden_states=encoded,
+                           use_cache=True, return_dict=True)
+        self_kv, cross_kv = stack_cache(out.past_key_values)
+        return out.logits[:, -1, :], self_kv, cross_kv
+
+
+class DecoderNext(torch.nn.Module):
+    def __init__(self, model):
+        super().__init__()
+        self.decoder = model.decoder
+
+    def forward(self, input_ids, encoded, self_kv, cross_kv):
+        out = self.decoder(input_ids=input_ids, encoder_hidden_states=encoded,
+                           past_key_values=model_cache(unstack_cache(self_kv, cross_kv)),
+                           use_cache=True, return_dict=True)
+        new_self_kv, _ = stack_cache(out.past_key_values)
+        return out.logits[:, -1, :], new_self_kv
+
+
+class Generator(torch.nn.Module):
+    decoder_start_token_id: int
+    eos_token_id: int
+
+    def __init__(self, encoder, first, step, start_token: int, eos_token: int):
+        super().__init__()
+        self.encoder = encoder
+        self.first = first
+        self.step = step
+        self.decoder_start_token_id = start_token
+        self.eos_token_id = eos_token
+
+    def forward(self, pixel_values: torch.Tensor) -> torch.Tensor:
+        return self.encoder(pixel_values)
+
+    @torch.jit.export
+    def encode(self, pixel_values: torch.Tensor) -> torch.Tensor:
+        return self.encoder(pixel_values)
+
+    @torch.jit.export
+    def decode_first(self, input_ids: torch.Tensor,
+                     encoded: torch.Tensor) -> Tuple[torch.Tensor, torch.Tensor, torch.Tensor]:
+        return self.first(input_ids, encoded)
+
+    @torch.jit.export
+    def decode_next(self, input_ids: torch.Tensor, encoded: torch.Tensor,
+                    self_kv: torch.Tensor,
+                    cross_kv: torch.Tensor) -> Tuple[torch.Tensor, torch.Tensor]:
+        return self.step(input_ids, encoded, self_kv, cross_kv)
+
+
+def greedy(generator, pixel_values, max_length):
+    encoded = generator.encode(pixel_values)
+    ids = torch.full((1, 1), generator.decoder_start_token_id, dtype=torch.long)
+    logits, self_kv, cross_kv = generator.decode_first(ids, encoded)
+    tokens = []
+    while len(tokens) < max_length:
+        nxt = int(logits.argmax(-1))
+        if nxt == generator.eos_token_id:
+            break
+        tokens.append(nxt)
+        ids = torch.full((1, 1), nxt, dtype=torch.long)
+        logits, self_kv = generator.decode_next(ids, encoded, self_kv, cross_kv)
+    return tokens
+
+
+GENERATOR_METHODS = ["encode", "decode_first", "decode_next"]
+
+
+def optimize_generator(scripted):
+    """Freeze and fuse the generator, keeping its entry points and token ids."""
+    frozen = torch.jit.freeze(
+        scripted.eval(),
+        preserved_attrs=GENERATOR_METHODS + ["decoder_start_token_id", "eos_token_id"])
+    return torch.jit.optimize_for_inference(frozen, other_methods=GENERATOR_METHODS)
+
+
+def quantize(model):
+    """Dynamic int8 quantization of every nn.Linear (weights int8, activations float)."""
+    return torch.ao.quantization.quantize_dynamic(model, {torch.nn.Linear}, dtype=torch.qint8)
+
+
+def special_token_ids(model):
+    config = model.config
+    eos = config.eos_token_id if config.eos_token_id is not None else config.decoder.eos_token_id
+    return config.decoder_start_token_id, eos
+
+
+def export_generator(model, pixel_values, output, max_length, optimize=False):
+    start, eos = special_token_ids(model)
+    with torch.no_grad():
+        encoder = Encoder(model).eval()
+        encoded = encoder(pixel_values)
+        ids = torch.full((1, 1), start, dtype=torch.long)
+        first = DecoderFirst(model).eval()
+        _, self_kv, cross_kv = first(ids, encoded)
+        step = DecoderNext(model).eval()
+        generator = Generator(
+            torch.jit.trace(encoder, pixel_values),
+            torch.jit.trace(first, (ids, encoded)),
+            torch.jit.trace(step, (ids, encoded, self_kv, cross_kv)),
+            start, eos)
+        scripted = torch.jit.script(generator)
+
+        # Tracing can bake sequence lengths into the step graph; compare the
+        # scripted loop with Hugging Face's own greedy search before saving.
+        expected = model.generate(pixel_values, max_new_tokens=max_length,
+                                  num_beams=1, do_sample=False)[0].tolist()[1:]
+        if eos in expected:
+            expected = expected[:expected.index(eos)]
+        actual = greedy(scripted, pixel_values, max_length)
+        if actual != expected:
+            raise SystemExit(f"Exported generator diverges from generate(): {actual} != {expected}")
+        if optimize:
+            scripted = optimize_generator(scripted)
+            # Fusion may reorder float math, so a different argmax is reported
+            # rather than fatal; eval_trocr.py measures the accuracy impact.
+            optimized = greedy(scripted, pixel_values, max_length)
+            if optimized != expected:
+                print(f"Warning: optimized generator output differs: {optimized} != {expected}")
+    scripted.save(output)
+    print(f"Wrote incremental generator to {output}")
+
+
+def token_bytes(tokenizer):
+    """UTF-8 bytes of every vocabulary entry with the tokenizer's encoding undone."""
+    vocab = tokenizer.convert_ids_to_tokens(list(range(len(tokenizer))))
+    # Byte-level BPE (RoBERTa, used by the base/large checkpoints) spells each
+    # byte as a printable character, e.g. a leading space as "\u0120".
+    # SentencePiece vocabularies (the small checkpoints) mark spaces with
+    # "\u2581" instead.
+    byte_level = any(token and token.startswith("\u0120") for token in vocab)
+    if byte_level:
+        from transformers.models.gpt2.tokenization_gpt2 import bytes_to_unicode
+        decoder = {char: byte for byte, char in bytes_to_unicode().items()}
+    out = []
+    for token in vocab:
+        token = token or ""
+        if byte_level and all(char in decoder for char in token):
+            out.append(bytes(decoder[char] for char in token))
+        else:
+            out.append(token.replace("\u2581", " ").encode("utf-8"))
+    return out
+
+
+def write_token_table(tokenizer, path, start, eos):
+    """Write tokens.bin; see core/recognition/TokenTable.hpp for the layout."""
+    entries = token_bytes(tokenizer)
+    special = set(tokenizer.all_special_ids)
+    offsets = [0]
+    for entry in entries:
+        offsets.append(offsets[-1] + len(entry))
+    with open(path + ".tmp", "wb") as handle:
+        handle.write(b"SCTK")
+        handle.write(struct.pack("<IIii", 1, len(entries), start, eos))
+        handle.write(struct.pack(f"<{len(offsets)}I", *offsets))
+        handle.write(bytes(1 if i in special else 0 for i in range(len(entries))))
+        handle.write(b"".join(entries))
+    os.replace(path + ".tmp", path)
+
+
+def table_decode(tokenizer, ids):
+    entries = token_bytes(tokenizer)
+    special = set(tokenizer.all_special_ids)
+    return b"".join(entries[i] for i in ids if i not in special).decode("utf-8", "replace")
+
+
+def export_onnx(model, tokenizer, pixel_values, out_dir, max_length):
+    start, eos = special_token_ids(model)
+    os.makedirs(out_dir, exist_ok=True)
+    with torch.no_grad():
+        encoder = Encoder(model).eval()
+        first = DecoderFirst(model).eval()
+        step = DecoderNext(model).eval()
+        encoded = encoder(pixel_values)
+        ids = torch.full((1, 1), start, dtype=torch.long)
+        _, self_kv, cross_kv = first(ids, encoded)
+        batch = {0: "batch"}
+        cache = {2: "batch", 4: "steps"}
+        torch.onnx.export(encoder, (pixel_values,), os.path.join(out_dir, "encoder.onnx"),
+                          input_names=["pixel_values"], output_names=["encoded"],
+                          dynamic_axes={"pixel_values": batch, "encoded": batch},
+                          opset_version=17)
+        torch.onnx.export(first, (ids, encoded), os.path.join(out_dir, "decoder_first.onnx"),
+                          input_names=["input_ids", "encoded"],
+                          output_names=["logits", "self_kv", "cross_kv"],
+                          dynamic_axes={"input_ids": batch, "encoded": batch, "logits": batch,
+                                        "self_kv": cache, "cross_kv": {2: "batch"}},
+                          opset_version=17)
+        # ONNX value names are unique per graph, so the updated cache cannot
+        # reuse the input's name.
+        torch.onnx.export(step, (ids, encoded, self_kv, cross_kv),
+                          os.path.join(out_dir, "decoder_next.onnx"),
+                          input_names=["input_ids", "encoded", "self_kv", "cross_kv"],
+                          output_names=["logits", "next_self_kv"],
+                          dynamic_axes={"input_ids": batch, "encoded": batch, "logits": batch,
+                                        "self_kv": cache, "cross_kv": {2: "batch"},
+                                        "next_self_kv": cache},
+                          opset_version=17)
+    write_token_table(tokenizer, os.path.join(out_dir, "tokens.bin"), start, eos)
+
+    expected = model.generate(pixel_values, max_new_tokens=max_length,
+                              num_beams=1, do_sample=False)[0].tolist()[1:]
+    if eos in expected:
+        expected = expected[:expected.index(eos)]
+    if table_decode(tokenizer, expected) != tokenizer.decode(expected, skip_special_tokens=True):
+        print("Warning: tokens.bin decodes the parity sample differently from the tokenizer")
+    try:
+        import onnxruntime as ort
+    except ImportError:
+        print("onnxruntime is not installed; skipping the ONNX parity check")
+    else:
+        sessions = {name: ort.InferenceSession(os.path.join(out_dir, f"{name}.onnx"))
+                    for name in ("encoder", "decoder_first", "decoder_next")}
+        enc = sessions["encoder"].run(None, {"pixel_values": pixel_values.numpy()})[0]
+        feed = [[start]]
+        logits, self_kv, cross_kv = sessions["decoder_first"].run(
+            None, {"input_ids": torch.tensor(feed).numpy(), "encoded": enc})
+        actual = []
+        while len(actual) < max_length:
+            nxt = int(logits[0].argmax())
+            if nxt == eos:
+                break
+            actual.append(nxt)
+            logits, self_kv = sessions["decoder_next"].run(
+                None, {"input_ids": torch.tensor([[nxt]]).numpy(), "encoded": enc,
+                       "self_kv": self_kv, "cross_kv": cross_kv})
+        if actual != expected:
+            raise SystemExit(f"ONNX graphs diverge from generate(): {actual} != {expected}")
+    print(f"Wrote ONNX graphs and token table to {out_dir}")
 
 
 def main() -> None:
-    model_name = "microsoft/trocr-base-stage1"
-    processor = TrOCRProcessor.from_pretrained(model_name)
-    model = VisionEncoderDecoderModel.from_pretrained(model_name).eval()
+    parser = argparse.ArgumentParser(description="Export TrOCR to TorchScript")
+    parser.add_argument("--model", default="microsoft/trocr-base-stage1")
+    parser.add_argument("--image", default="dummy.png", help="Sample image used for tracing")
+    parser.add_argument("--output", default="trocr_generator.pt")
+    parser.add_argument("--processor_dir", default="./trocr_processor")
+    parser.add_argument("--max_length", type=int, default=16,
+                        help="Tokens generated by the export-time parity check")
+    parser.add_argument("--legacy", action="store_true",
+                        help="Write the single-pass traced model (trocr_traced.pt) instead")
+    parser.add_argument("--quantize", action="store_true",
+                        help="Dynamically quantize linear layers to int8 before export")
+    parser.add_argument("--optimize", action="store_true",
+                        help="Freeze the generator and run optimize_for_inference on it")
+    parser.add_argument("--onnx", metavar="DIR",
+                        help="Write ONNX graphs and a token table to DIR instead of TorchScript")
+    args = parser.parse_args()
+    if args.onnx and (args.quantize or args.optimize or args.legacy):
+        parser.error("--quantize, --optimize and --legacy apply to TorchScript exports; "
+                     "quantize ONNX graphs with onnxruntime.quantization instead")
+
+    processor = TrOCRProcessor.from_pretrained(args.model)
+    model = VisionEncoderDecoderModel.from_pretrained(args.model).eval()
+    if args.quantize:
+        model = quantize(model)
 
-    # Use a dummy image to trace the model
-    image = Image.open("dummy.png").convert("RGB")
+    # Use a sample image to trace the model
+    image = Image.open(args.image).convert("RGB")
     pixel_values = processor(images=image, return_tensors="pt").pixel_values
 
-    traced = torch.jit.trace(model, pixel_values)
-    traced.save("trocr_traced.pt")
+    if args.onnx:
+        export_onnx(model, processor.tokenizer, pixel_values, args.onnx, args.max_length)
+    elif args.legacy:
+        traced = torch.jit.trace(model, pixel_values)
+        traced.save("trocr_traced.pt" if args.output == "trocr_generator.pt" else args.output)
+    else:
+        export_generator(model, pixel_values, args.output, args.max_length, args.optimize)
 
-    # Save tokenizer/processor for use in C++
-    processor.save_pretrained("./trocr_processor")
+    # Save tokenizer/processor for use in C++, plus the precomputed token
+    # table the decoder prefers over the tokenizer.
+    processor.save_pretrained(args.processor_dir)
+    if not args.onnx:
+        start, eos = special_token_ids(model)
+        write_token_table(processor.tokenizer, os.path.join(args.processor_dir, "tokens.bin"),
+                          start, eos)
 
 
 if __name__ == "__main__":
@@ -1,9 +1,12 @@
 #!/usr/bin/env python3
 """Basic training routine for SymbolCast gesture models."""
 import argparse
+import os
+import struct
 from pathlib import Path
 import numpy as np
 from sklearn.neighbors import KNeighborsClassifier
+from sklearn.neural_network import MLPClassifier
 from sklearn.preprocessing import StandardScaler
 from sklearn.pipeline import Pipeline
 # Basic model training using scikit-learn. Provides optional augmentation and
@@ -14,6 +17,53 @@ from sklearn.model_selection import train_test_split, cross_val_score
 
 # TODO: add data augmentation and cross-validation
 
+
+def write_native_model(pipeline, path):
+    """Write the fitted pipeline in the compact format read by
+    core/recognition/NativeModel.hpp."""
+    scaler = pipeline.named_steps["scaler"]
+    clf = pipeline.steps[-1][1]
+    dim = scaler.mean_.shape[0]
+    labels = [str(c) for c in clf.classes_]
+    is_mlp = isinstance(clf, MLPClassifier)
+
+    def floats(values):
+        arr = np.asarray(values, dtype="<f4").ravel()
+        return arr.tobytes()
+
+    out = bytearray(b"SCNM")
+    out += struct.pack("<III", 2, 1 if is_mlp else 0, dim)
+    out += floats(scaler.mean_)
+    out += floats(scaler.scale_)
+    out += struct.pack("<I", len(labels))
+    for label in labels:
+        encoded = label.encode("utf-8")
+        out += struct.pack("<I", len(encoded)) + encoded
+    # Version 2 keeps the weight arrays 4-byte aligned so a memory-mapped
+    # file can be used in place.
+    out += b"\0" * (-len(out) % 4)
+    if is_mlp:
+        out += struct.pack("<I", len(clf.coefs_))
+        for weights, bias in zip(clf.coefs_, clf.intercepts_):
+            n_in, n_out = weights.shape
+            out += struct.pack("<II", n_in, n_out)
+            out += floats(weights.T)
+            out += floats(bias)
+    else:
+        refs = clf._fit_X
+        out += struct.pack("<II", clf.n_neighbors, refs.shape[0])
+        out += floats(refs)
+        out += np.asarray(clf._y, dtype="<u4").tobytes()
+
+    path = Path(path)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    # Replace atomically: a running app may have the old file mapped.
+    tmp = path.with_name(path.name + ".tmp")
+    tmp.write_bytes(bytes(out))
+    os.replace(tmp, path)
+    print(f"Wrote native model ({len(out)} bytes) to {path}")
+
+
 def main():
     parser = argparse.ArgumentParser(description="Train symbol recognition model")
     parser.add_argument("--data_dir", required=True, help="Directory of labeled CSV files")
@@ -21,6 +71,10 @@ def main():
     parser.add_argument("--max_points", type=int, default=3, help="Number of points to use per sample")
     parser.add_argument("--augment", type=int, default=0,
                         help="Number of jittered copies to add per sample")
+    parser.add_argument("--classifier", choices=["knn", "mlp"], default="knn",
+                        help="Classifier placed after the scaler")
+    parser.add_argument("--native_model",
+                        help="Also write a compact model for the built-in C++ engine")
     args = parser.parse_args()
 
     data_dir = Path(args.data_dir)
@@ -47,9 +101,13 @@ def main():
             y.append(label)
 
     X = np.array(X, dtype=np.float32)
+    if args.classifier == "mlp":
+        classifier = ("mlp", MLPClassifier(hidden_layer_sizes=(32,), max_iter=2000))
+    else:
+        classifier = ("knn", KNeighborsClassifier(n_neighbors=1))
     pipeline = Pipeline([
         ("scaler", StandardScaler()),
-        ("knn", KNeighborsClassifier(n_neighbors=1)),
+        classifier,
     ])
     scores = cross_val_score(pipeline, X, y, cv=3)
     print(f"Cross-val accuracy: {scores.mean():.2f} (+/- {scores.std():.2f})")
@@ -64,5 +122,8 @@ def main():
         f.write(onnx_model.SerializeToString())
     print(f"Wrote ONNX model with {len(samples)} samples to {output}")
 
+    if args.native_model:
+        write_native_model(pipeline, args.native_model)
+
 if __name__ == "__main__":
     main()
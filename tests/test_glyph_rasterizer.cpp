@@ -0,0 +1,81 @@
+#include "core/recognition/GlyphRasterizer.hpp"
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+static float at(const std::vector<float>& buf, int size, int x, int y) {
+    return buf[static_cast<size_t>(y) * size + x];
+}
+
+int main() {
+    sc::GlyphRasterizer raster;
+    sc::GlyphRasterOptions opts;
+    opts.size = 64;
+    opts.margin = 0.25f;
+    opts.strokeWidth = 0.f;
+    opts.minStrokeWidth = 3.f;
+
+    // Nothing captured: a blank buffer of the requested size.
+    const auto& blank = raster.rasterize({}, opts);
+    assert(blank.size() == 64u * 64u);
+    for (float v : blank)
+        assert(v == 0.f);
+
+    // A horizontal line is fitted between the margins and centred vertically.
+    std::vector<std::vector<sc::Point>> line{{{10.f, 5.f}, {110.f, 5.f}}};
+    const auto& h = raster.rasterize(line, opts);
+    assert(raster.size() == 64);
+    assert(at(h, 64, 32, 32) == 1.f);
+    assert(at(h, 64, 32, 31) == 1.f);
+    assert(at(h, 64, 32, 20) == 0.f);
+    assert(at(h, 64, 2, 32) == 0.f);
+    assert(at(h, 64, 61, 32) == 0.f);
+    // The edge is antialiased rather than stepped.
+    float partial = at(h, 64, 32, 30);
+    assert(partial > 0.f && partial < 1.f);
+    assert(at(h, 64, 32, 28) == 0.f);
+    // Ink stays inside the margin plus the pen radius.
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            if (x < 12 || x > 51)
+                assert(at(h, 64, x, y) == 0.f);
+
+    // Coverage is symmetric about the line.
+    for (int d = 0; d < 6; ++d)
+        assert(std::fabs(at(h, 64, 32, 31 - d) - at(h, 64, 32, 32 + d)) < 1e-5f);
+
+    // A vertical line has zero width but must still be drawn.
+    std::vector<std::vector<sc::Point>> vertical{{{3.f, 0.f}, {3.f, 40.f}}};
+    const auto& v = raster.rasterize(vertical, opts);
+    assert(at(v, 64, 32, 32) == 1.f);
+    assert(at(v, 64, 20, 32) == 0.f);
+
+    // A single tap becomes a dot in the middle.
+    std::vector<std::vector<sc::Point>> dot{{{7.f, 7.f}}};
+    const auto& d = raster.rasterize(dot, opts);
+    assert(at(d, 64, 32, 32) == 1.f);
+    assert(at(d, 64, 40, 32) == 0.f);
+
+    // Overlapping strokes saturate instead of accumulating.
+    std::vector<std::vector<sc::Point>> cross{{{0.f, 50.f}, {100.f, 50.f}},
+                                              {{50.f, 0.f}, {50.f, 100.f}},
+                                              {{0.f, 50.f}, {100.f, 50.f}}};
+    const auto& c = raster.rasterize(cross, opts);
+    for (float value : c)
+        assert(value >= 0.f && value <= 1.f);
+    assert(at(c, 64, 32, 32) == 1.f);
+
+    // The stroke width scales with the glyph.
+    opts.strokeWidth = 25.f;
+    std::vector<std::vector<sc::Point>> small{{{0.f, 0.f}, {100.f, 0.f}}};
+    const auto& wide = raster.rasterize(small, opts);
+    assert(at(wide, 64, 32, 32 - 3) == 1.f);
+    assert(at(wide, 64, 32, 32 + 2) == 1.f);
+
+    // A smaller size reuses the same buffer.
+    opts.size = 16;
+    const auto& tiny = raster.rasterize(line, opts);
+    assert(tiny.size() == 16u * 16u);
+    assert(raster.data() == tiny.data());
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "core/recognition/ImagePreprocess.hpp"
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+int main() {
+    // Odd width and padded rows exercise the scalar tail and the stride.
+    const int width = 13;
+    const int height = 5;
+    const size_t stride = width * 4 + 12;
+    std::vector<uint8_t> pixels(stride * height, 0xee);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            for (int b = 0; b < 4; ++b)
+                pixels[y * stride + 4 * x + b] = static_cast<uint8_t>((y * 31 + x * 7 + b * 50) & 0xff);
+
+    const sc::ChannelNorm norm{{0.1f, 0.2f, 0.3f}, {0.5f, 0.25f, 2.f}};
+    struct Case {
+        sc::PixelLayout layout;
+        int r, g, b;
+    };
+    const Case cases[] = {{sc::PixelLayout::Rgba, 0, 1, 2},
+                          {sc::PixelLayout::Bgra, 2, 1, 0},
+                          {sc::PixelLayout::Argb, 1, 2, 3}};
+    for (const Case& c : cases) {
+        std::vector<float> out(3 * width * height, -100.f);
+        sc::packedToPlanar(pixels.data(), width, height, stride, c.layout, norm, out.data());
+        const int bytes[3] = {c.r, c.g, c.b};
+        for (int ch = 0; ch < 3; ++ch) {
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    float v = pixels[y * stride + 4 * x + bytes[ch]] / 255.f;
+                    float expected = (v - norm.mean[ch]) / norm.std[ch];
+                    float actual = out[(ch * height + y) * width + x];
+                    assert(std::fabs(actual - expected) < 1e-5f);
+                }
+            }
+        }
+    }
+
+    // White maps to 1 and black to -1 with the TrOCR normalization.
+    uint8_t bw[8] = {255, 255, 255, 255, 0, 0, 0, 255};
+    float planes[6];
+    sc::packedToPlanar(bw, 2, 1, sizeof(bw), sc::PixelLayout::Rgba, sc::kTrocrNorm, planes);
+    for (int ch = 0; ch < 3; ++ch) {
+        assert(std::fabs(planes[2 * ch] - 1.f) < 1e-6f);
+        assert(std::fabs(planes[2 * ch + 1] + 1.f) < 1e-6f);
+    }
+
+    // Coverage is ink: 0 reads as white paper, 1 as black.
+    const float coverage[3] = {0.f, 1.f, 0.25f};
+    float covPlanes[9];
+    sc::coverageToPlanar(coverage, 3, 1, sc::kTrocrNorm, covPlanes);
+    for (int ch = 0; ch < 3; ++ch) {
+        assert(std::fabs(covPlanes[3 * ch] - 1.f) < 1e-6f);
+        assert(std::fabs(covPlanes[3 * ch + 1] + 1.f) < 1e-6f);
+        assert(std::fabs(covPlanes[3 * ch + 2] - 0.5f) < 1e-6f);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "core/input/InputManager.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+int main() {
+    // Defaults keep every raw point, duplicates included.
+    sc::InputManager raw;
+    raw.startCapture();
+    for (int i = 0; i < 10; ++i)
+        assert(raw.addPoint(1.f, 1.f, static_cast<uint64_t>(i)));
+    raw.stopCapture();
+    assert(raw.points().size() == 10);
+    assert(raw.sessionStats().reductionRatio() == 0.0);
+
+    // One Euro smoothing: a constant signal passes through, noise shrinks.
+    sc::OneEuroFilter euro(1.0, 0.0, 1.0);
+    assert(euro.filter(5.0, 0.0) == 5.0);
+    assert(std::fabs(euro.filter(5.0, 0.01) - 5.0) < 1e-9);
+    const double jumped = euro.filter(6.0, 0.01);
+    assert(jumped > 5.0 && jumped < 5.2);
+
+    // High-rate input along a straight line collapses to sparse points;
+    // the corner of an L-shape (within maxSpacing * tan(turnDegrees)) and
+    // both endpoints survive.
+    sc::InputFilterSettings settings;
+    settings.minSpacing = 2.f;
+    settings.maxSpacing = 20.f;
+    settings.turnDegrees = 10.f;
+    sc::InputManager mgr;
+    mgr.setFilterSettings(settings);
+    mgr.startCapture();
+    uint64_t t = 0;
+    for (int i = 0; i <= 1000; ++i)
+        mgr.addPoint(i * 0.1f, 0.f, t++);
+    for (int i = 1; i <= 1000; ++i)
+        mgr.addPoint(100.f, i * 0.1f, t++);
+    mgr.stopCapture();
+    const auto& pts = mgr.points();
+    assert(pts.size() < 30);
+    assert(pts.front().x == 0.f && pts.front().y == 0.f);
+    assert(pts.back().x == 100.f && pts.back().y == 100.f);
+    bool corner = false;
+    for (const auto& p : pts)
+        corner = corner || (std::fabs(p.x - 100.f) < 0.5f && p.y < 3.6f);
+    assert(corner);
+    const sc::InputFilterStats gesture = mgr.gestureStats();
+    assert(gesture.raw == 2001 && gesture.kept == pts.size());
+    assert(gesture.reductionRatio() > 0.98);
+    assert(mgr.sessionStats().raw == 2001);
+
+    // A dropped endpoint is stored on stopCapture() with its own timestamp
+    // and pressure.
+    {
+        sc::InputFilterSettings sparse;
+        sparse.minSpacing = 5.f;
+        sc::InputManager end;
+        end.setFilterSettings(sparse);
+        end.startCapture();
+        assert(end.addPoint(0.f, 0.f, 10, 1.f));
+        assert(!end.addPoint(1.f, 0.f, 17, 0.5f));
+        end.stopCapture();
+        const sc::PointBuffer& buf = end.buffer();
+        assert(buf.size() == 2 && buf.x()[1] == 1.f);
+        assert(buf.timestamps()[1] == 17);
+        assert(buf.pressure()[1] == 0.5f);
+    }
+
+    // The per-gesture cap holds and keeps both ends.
+    sc::InputFilterSettings capped;
+    capped.maxPoints = 64;
+    mgr.setFilterSettings(capped);
+    mgr.startCapture();
+    for (int i = 0; i < 5000; ++i)
+        mgr.addPoint(static_cast<float>(i), std::sin(i * 0.01f), static_cast<uint64_t>(i));
+    mgr.stopCapture();
+    assert(mgr.points().size() <= 64 && mgr.points().size() >= 32);
+    assert(mgr.points().front().x == 0.f);
+    assert(mgr.points().back().x == 4999.f);
+    assert(mgr.sessionStats().raw == 7001);
+
+    // Smoothing runs before decimation; points() holds the smoothed values.
+    sc::InputFilterSettings smooth;
+    smooth.smoothing = true;
+    smooth.beta = 0.0;
+    mgr.setFilterSettings(smooth);
+    mgr.startCapture();
+    mgr.addPoint(0.f, 0.f, 0);
+    mgr.addPoint(10.f, 0.f, 8);
+    mgr.stopCapture();
+    assert(mgr.points().size() == 2);
+    assert(mgr.points()[1].x > 0.f && mgr.points()[1].x < 10.f);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "core/input/InputMultiplexer.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Point x encodes the device, y the point's index in its gesture, so a
+// gesture mixing devices or reordering points is detectable.
+bool gestureIsClean(const sc::DeviceGesture& g) {
+    const auto xs = g.points.x();
+    const auto ys = g.points.y();
+    for (size_t i = 0; i < g.points.size(); ++i) {
+        if (xs[i] != static_cast<float>(g.device) || ys[i] != static_cast<float>(i))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    // Interleaved events from two devices stay in separate gestures.
+    {
+        std::vector<sc::DeviceGesture> out;
+        std::mutex outMutex;
+        {
+            sc::InputMultiplexer mux([&](const sc::DeviceGesture& g) {
+                std::lock_guard<std::mutex> lock(outMutex);
+                out.push_back(g);
+            });
+            assert(mux.onTap(1, 0, 1.f, 0.f) == sc::TapAction::ResetDrawing);
+            assert(mux.onTap(2, 50, 2.f, 0.f) == sc::TapAction::ResetDrawing);
+            // Device 2's tap does not complete device 1's double tap.
+            assert(mux.onTap(1, 100, 1.f, 0.f) == sc::TapAction::StartSequence);
+            assert(mux.capturing(1) && !mux.capturing(2));
+            assert(mux.onTap(2, 120, 2.f, 0.f) == sc::TapAction::StartSequence);
+            for (int i = 1; i < 10; ++i) {
+                assert(mux.onMove(1, 1.f, static_cast<float>(i), 100 + i));
+                assert(mux.onMove(2, 2.f, static_cast<float>(i), 120 + i));
+            }
+            assert(!mux.onMove(3, 3.f, 0.f, 0)); // idle device captures nothing
+            mux.onTap(2, 1000, 2.f, 10.f);
+            assert(mux.onTap(2, 1100, 2.f, 11.f) == sc::TapAction::EndSequence);
+            mux.waitIdle();
+            assert(mux.stats().recognized == 1 && mux.capturing(1));
+            assert(mux.deviceCount() == 3);
+            mux.removeDevice(3);
+            assert(mux.deviceCount() == 2);
+            mux.onTap(1, 2000, 1.f, 10.f);
+            assert(mux.onTap(1, 2100, 1.f, 11.f) == sc::TapAction::EndSequence);
+        } // destructor recognizes what is still queued
+        assert(out.size() == 2);
+        assert(out[0].device == 2 && out[1].device == 1);
+        for (const auto& g : out) {
+            // Start tap, nine moves and the first tap of the closing pair.
+            assert(g.points.size() == 11);
+            assert(gestureIsClean(g));
+        }
+    }
+
+    // Load test: many synthetic sources fed concurrently from several
+    // threads, each source drawing several gestures.
+    {
+        const uint32_t kThreads = 4;
+        const uint32_t kDevicesPerThread = 32;
+        const int kGestures = 5;
+        const int kMoves = 60;
+        std::atomic<uint64_t> clean{0};
+        std::atomic<uint64_t> points{0};
+        sc::InputMultiplexer mux(
+            [&](const sc::DeviceGesture& g) {
+                if (gestureIsClean(g))
+                    clean.fetch_add(1);
+                points.fetch_add(g.points.size());
+            },
+            2, 1 << 16);
+
+        std::vector<std::thread> producers;
+        for (uint32_t t = 0; t < kThreads; ++t) {
+            producers.emplace_back([&, t] {
+                uint64_t now = 0;
+                for (int g = 0; g < kGestures; ++g) {
+                    // Advance every device of this thread in lockstep so
+                    // their gestures overlap in time.
+                    auto forEach = [&](auto&& fn) {
+                        for (uint32_t d = 0; d < kDevicesPerThread; ++d)
+                            fn(t * kDevicesPerThread + d);
+                    };
+                    forEach([&](uint32_t dev) { mux.onTap(dev, now, float(dev), 0.f); });
+                    now += 100;
+                    forEach([&](uint32_t dev) { mux.onTap(dev, now, float(dev), 0.f); });
+                    for (int i = 1; i <= kMoves; ++i) {
+                        now += 5;
+                        forEach([&](uint32_t dev) { mux.onMove(dev, float(dev), float(i), now); });
+                        if (i % 16 == 0)
+                            std::this_thread::yield();
+                    }
+                    now += 500;
+                    forEach(
+                        [&](uint32_t dev) { mux.onTap(dev, now, float(dev), float(kMoves + 1)); });
+                    now += 100;
+                    forEach([&](uint32_t dev) { mux.onTap(dev, now, float(dev), 0.f); });
+                    now += 1000;
+                }
+            });
+        }
+        for (std::thread& p : producers)
+            p.join();
+        mux.waitIdle();
+
+        const uint64_t expected = uint64_t(kThreads) * kDevicesPerThread * kGestures;
+        const sc::InputMultiplexerStats stats = mux.stats();
+        assert(stats.devices == kThreads * kDevicesPerThread);
+        assert(stats.dropped == 0);
+        assert(stats.submitted == expected && stats.recognized == expected);
+        assert(clean.load() == expected);
+        assert(points.load() == expected * (kMoves + 2));
+    }
+
+    // Devices can be removed while other threads are feeding them.
+    {
+        std::atomic<bool> done{false};
+        sc::InputMultiplexer mux([](const sc::DeviceGesture&) {}, 1, 1 << 16);
+        std::vector<std::thread> feeders;
+        for (uint32_t t = 0; t < 2; ++t) {
+            feeders.emplace_back([&, t] {
+                uint64_t now = 0;
+                for (int g = 0; g < 200; ++g) {
+                    const uint32_t dev = t * 4 + static_cast<uint32_t>(g % 4);
+                    mux.onTap(dev, now, 0.f, 0.f);
+                    mux.onTap(dev, now += 100, 0.f, 0.f);
+                    for (int i = 1; i <= 10; ++i)
+                        mux.onMove(dev, 0.f, float(i), now += 5);
+                    mux.onTap(dev, now += 500, 0.f, 0.f);
+                    mux.onTap(dev, now += 100, 0.f, 0.f);
+                    now += 1000;
+                }
+            });
+        }
+        std::thread remover([&] {
+            while (!done) {
+                for (uint32_t dev = 0; dev < 8; ++dev)
+                    mux.removeDevice(dev);
+                std::this_thread::yield();
+            }
+        });
+        for (std::thread& f : feeders)
+            f.join();
+        done = true;
+        remover.join();
+        mux.waitIdle();
+        const sc::InputMultiplexerStats stats = mux.stats();
+        assert(stats.recognized == stats.submitted && stats.dropped == 0);
+        assert(stats.devices <= 8);
+    }
+
+    // A full queue drops gestures instead of blocking input.
+    {
+        std::mutex gate;
+        std::unique_lock<std::mutex> hold(gate);
+        sc::InputMultiplexer mux(
+            [&](const sc::DeviceGesture&) { std::lock_guard<std::mutex> wait(gate); }, 1, 2);
+        for (uint32_t dev = 0; dev < 6; ++dev) {
+            mux.onTap(dev, 0, 0.f, 0.f);
+            mux.onTap(dev, 100, 0.f, 0.f);
+            mux.onTap(dev, 1000, 0.f, 0.f);
+            mux.onTap(dev, 1100, 0.f, 0.f);
+        }
+        const sc::InputMultiplexerStats stats = mux.stats();
+        assert(stats.submitted + stats.dropped == 6);
+        assert(stats.dropped >= 3); // at most one in flight plus two queued
+        hold.unlock();
+        mux.waitIdle();
+        assert(mux.stats().recognized == stats.submitted);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "core/input/InputReplayer.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Type = sc::InputRecord::Type;
+
+// Two gestures: double tap, a stroke of moves, double tap to submit.
+void writeSession(sc::InputRecorder& rec) {
+    uint64_t t = 1000;
+    for (int g = 0; g < 2; ++g) {
+        rec.record(Type::Tap, sc::InputDevice::Touch, t, 10.f, 10.f);
+        rec.record(Type::Tap, sc::InputDevice::Touch, t += 100, 10.f, 10.f);
+        for (int i = 1; i <= 20; ++i)
+            rec.record(Type::Move, sc::InputDevice::Touch, t += 8, 10.f + i * 2.f, 10.f + i);
+        rec.record(Type::Tap, sc::InputDevice::Touch, t += 500, 50.f, 30.f);
+        rec.record(Type::Tap, sc::InputDevice::Touch, t += 100, 50.f, 30.f);
+        t += 1000;
+    }
+    // Moves while idle are recorded but not captured.
+    rec.record(Type::Move, sc::InputDevice::Mouse, t + 5000, 1.f, 2.f);
+}
+
+std::vector<std::vector<sc::Point>> replayGestures(const std::vector<sc::InputRecord>& records,
+                                                   sc::ReplayReport& report) {
+    std::vector<std::vector<sc::Point>> gestures;
+    sc::InputManager input;
+    sc::InputReplayer replayer;
+    size_t predictions = 0;
+    replayer.setPredict([&](const sc::InputManager&) { ++predictions; });
+    replayer.setSubmit(
+        [&](const sc::InputManager& in) { gestures.push_back(in.points().toVector()); });
+    report = replayer.run(records, input);
+    assert(predictions == report.keptPoints);
+    return gestures;
+}
+
+} // namespace
+
+int main() {
+    const std::string path = "test_input_recorder.scil";
+    {
+        sc::InputRecorder rec;
+        assert(rec.open(path));
+        writeSession(rec);
+        assert(rec.eventCount() == 2 * 24 + 1);
+    } // destructor flushes
+
+    std::vector<sc::InputRecord> records;
+    uint64_t epochMs = 0;
+    assert(sc::readInputLog(path, records, &epochMs));
+    assert(records.size() == 49);
+    assert(epochMs > 0);
+    assert(records[0].type == Type::Tap && records[0].device == sc::InputDevice::Touch);
+    assert(records[0].timestampMs == 1000 && records[1].timestampMs == 1100);
+    assert(records[2].type == Type::Move && records[2].x == 12.f && records[2].y == 11.f);
+    assert(records.back().device == sc::InputDevice::Mouse);
+
+    // Each gesture holds its start tap, its moves and the first tap of the
+    // closing double tap (captured like the canvas does); a second
+    // replay of the same log produces identical gestures.
+    sc::ReplayReport report;
+    const auto first = replayGestures(records, report);
+    assert(report.events == 49);
+    assert(report.gestures == 2);
+    assert(report.keptPoints == 2 * 22);
+    assert(report.stages.size() == 3 && report.stages[0].name == "ingest");
+    assert(report.stages[0].count == 49 && report.stages[2].count == 2);
+    assert(report.stages[0].p50Ms <= report.stages[0].p99Ms);
+    assert(first.size() == 2 && first[0].size() == 22);
+    assert(first[0].front().x == 10.f && first[0].back().x == 50.f);
+    sc::ReplayReport again;
+    const auto second = replayGestures(records, again);
+    assert(second.size() == first.size());
+    for (size_t g = 0; g < first.size(); ++g)
+        for (size_t i = 0; i < first[g].size(); ++i)
+            assert(first[g][i].x == second[g][i].x && first[g][i].y == second[g][i].y);
+
+    // Device profiles: the touch gestures replay with the touch filter,
+    // which drops moves closer than 5 px to the last kept point.
+    {
+        sc::InputManager filtered;
+        sc::InputReplayer replayer;
+        sc::InputFilterSettings touch;
+        touch.minSpacing = 5.f;
+        replayer.setDeviceFilter(sc::InputDevice::Touch, touch);
+        replayer.setDeviceFilter(sc::InputDevice::Mouse, sc::InputFilterSettings());
+        const sc::ReplayReport profiled = replayer.run(records, filtered);
+        assert(profiled.gestures == 2);
+        assert(profiled.keptPoints < report.keptPoints);
+        assert(filtered.filterSettings().minSpacing == 5.f);
+    }
+
+    // Real time at 100x still takes roughly the recorded span.
+    sc::InputManager input;
+    sc::ReplayOptions realtime;
+    realtime.realtime = true;
+    realtime.speed = 100.0;
+    const sc::ReplayReport timed = sc::InputReplayer().run(records, input, realtime);
+    const double spanMs = static_cast<double>(records.back().timestampMs - records[0].timestampMs);
+    assert(timed.wallMs >= spanMs / 100.0 * 0.9);
+
+    // Large deltas use multi-byte varints; a truncated tail keeps the
+    // complete events before it.
+    {
+        sc::InputRecorder rec(path);
+        rec.record(Type::Tap, sc::InputDevice::Pen, 5, 1.f, 1.f);
+        rec.record(Type::Move, sc::InputDevice::Vr, 5 + 1000000, 2.f, 3.f);
+        rec.record(Type::Move, sc::InputDevice::Vr, 4, 2.f, 3.f); // clamped
+    }
+    assert(sc::readInputLog(path, records) && records.size() == 3);
+    assert(records[1].timestampMs == 1000005 && records[1].device == sc::InputDevice::Vr);
+    assert(records[2].timestampMs == 1000005);
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 3));
+    }
+    assert(sc::readInputLog(path, records) && records.size() == 2);
+
+    // Bad magic and missing files are rejected.
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "NOPE0000000000000000";
+    }
+    assert(!sc::readInputLog(path, records) && records.empty());
+    std::remove(path.c_str());
+    assert(!sc::readInputLog(path, records));
+    return 0;
+}
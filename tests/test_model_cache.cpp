@@ -0,0 +1,101 @@
+#include "core/recognition/RecognizerRouter.hpp"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+struct Writer {
+    std::string bytes{"SCNM"};
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            bytes.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+    void f32(float f) {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        u32(bits);
+    }
+    void label(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes += s;
+    }
+};
+
+// 1-NN over two references; labels of odd length so version 2 needs padding.
+std::string knnModel(uint32_t version) {
+    Writer w;
+    w.u32(version); w.u32(0); w.u32(2);
+    w.f32(0.f); w.f32(0.f);
+    w.f32(1.f); w.f32(1.f);
+    w.u32(2); w.label("dot"); w.label("line");
+    if (version >= 2)
+        while (w.bytes.size() % 4)
+            w.bytes.push_back('\0');
+    w.u32(1); w.u32(2);
+    w.f32(0.f); w.f32(0.f);
+    w.f32(5.f); w.f32(5.f);
+    w.u32(0); w.u32(1);
+    return w.bytes;
+}
+
+void writeFile(const char* path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary);
+    out << bytes;
+}
+
+} // namespace
+
+int main() {
+    writeFile("cache-knn.scm", knnModel(2));
+    writeFile("cache-knn-v1.scm", knnModel(1));
+
+    {
+        sc::MappedFile file("cache-knn.scm");
+        assert(file.opened() && file.valid());
+        assert(file.size() == knnModel(2).size());
+        assert(std::memcmp(file.data(), "SCNM", 4) == 0);
+        sc::MappedFile missing("cache-missing.scm");
+        assert(!missing.opened() && !missing.valid() && missing.size() == 0);
+    }
+
+    // Two router keys on one file share a single mapping.
+    {
+        std::ofstream cfg("cache-models.json");
+        cfg << "{\n  \"shape_model\": \"cache-knn.scm\",\n  \"letter_model\": \"./cache-knn.scm\"\n}\n";
+    }
+    {
+        sc::RecognizerRouter router("cache-models.json");
+        assert(sc::ModelCache::instance().size() == 1);
+        assert(router.recognize({{0.1f, 0.2f}}, "shape_model") == "dot");
+        assert(router.recognize({{4.f, 6.f}}, "letter_model") == "line");
+        auto report = router.memoryReport();
+        assert(report.size() == 2);
+        for (const auto& entry : report) {
+            assert(entry.second.sharedBy == 2);
+            assert(entry.second.fileBytes == knnModel(2).size());
+            assert(entry.second.residentBytes > 0);
+            // Only the inverted scale is copied; the rest is read in place.
+            assert(entry.second.privateBytes == 2 * sizeof(float) + 2 * sizeof(uint32_t));
+        }
+    }
+    assert(sc::ModelCache::instance().size() == 0);
+
+    // Version 1 files and in-memory loads copy their weights instead.
+    sc::ModelRunner v1;
+    assert(v1.loadModel("cache-knn-v1.scm"));
+    assert(v1.run({{5.f, 4.f}}) == "line");
+    assert(v1.memoryUsage().sharedBy == 1);
+    const std::string bytes = knnModel(2);
+    sc::NativeModel copied;
+    assert(copied.loadFromMemory(bytes.data(), bytes.size()));
+    assert(copied.ownedBytes() == copied.weightBytes());
+    assert(copied.predict({{0.f, 1.f}}) == "dot");
+
+    // Missing and malformed files still fail to load.
+    sc::ModelRunner runner;
+    assert(!runner.loadModel("cache-missing.scm"));
+    writeFile("cache-bad.scm", "SCNM");
+    assert(!runner.loadModel("cache-bad.scm"));
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include "core/recognition/RecognizerRouter.hpp"
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+int main() {
+    sc::RecognizerRouter router("missing-models.json");
+    sc::ModelWarmup warmup(2, 0.0);
+    assert(!warmup.ready());
+    router.addWarmupTasks(warmup);
+    warmup.add("custom", [] { return false; });
+    std::atomic<bool> notified{false};
+    warmup.setOnReady([&] {
+        assert(warmup.ready());
+        notified = true;
+    });
+    warmup.start();
+    warmup.wait();
+    assert(warmup.ready());
+    auto report = warmup.report();
+    assert(report.size() == 3);
+    for (const auto& t : report) {
+        assert(t.coldMs >= 0.0);
+        if (t.name == "custom")
+            assert(!t.ok && t.warmMs == 0.0);
+        else
+            assert(t.ok);
+    }
+    // The callback runs on the warm-up thread right after wait() returns.
+    while (!notified)
+        std::this_thread::yield();
+    // The router is safe to use once warm-up reports ready.
+    assert(!router.recognize(sc::makeWarmupGesture(8)).empty());
+    return 0;
+}
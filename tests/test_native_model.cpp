@@ -0,0 +1,76 @@
+#include "core/recognition/ModelRunner.hpp"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+struct Writer {
+    std::string bytes{"SCNM"};
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            bytes.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+    void f32(float f) {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        u32(bits);
+    }
+    void label(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes += s;
+    }
+};
+
+} // namespace
+
+int main() {
+    // 1-NN over two points (dim 2), scaler doubles then shifts by one.
+    Writer knn;
+    knn.u32(1); knn.u32(0); knn.u32(2);
+    knn.f32(1.f); knn.f32(1.f);     // mean
+    knn.f32(0.5f); knn.f32(0.5f);   // scale
+    knn.u32(2); knn.label("circle"); knn.label("square");
+    knn.u32(1); knn.u32(2);
+    knn.f32(-2.f); knn.f32(-2.f);   // scaled (0,0)
+    knn.f32(2.f); knn.f32(2.f);     // scaled (2,2)
+    knn.u32(0); knn.u32(1);
+    {
+        std::ofstream out("native-knn.scm", std::ios::binary);
+        out << knn.bytes;
+    }
+
+    sc::NativeModel model;
+    assert(model.load("native-knn.scm"));
+    assert(model.kind() == sc::NativeModel::Kind::Knn && model.inputDim() == 2);
+    assert(model.predict({{0.1f, 0.2f}}) == "circle");
+    assert(model.predict({{1.8f, 2.1f}, {9.f, 9.f}}) == "square");
+
+    sc::ModelRunner runner;
+    assert(runner.loadModel("native-knn.scm"));
+    assert(runner.usesNativeModel());
+    assert(runner.run({{1.9f, 1.9f}}) == "square");
+
+    // One hidden ReLU layer picking the larger of the two inputs.
+    Writer mlp;
+    mlp.u32(1); mlp.u32(1); mlp.u32(2);
+    mlp.f32(0.f); mlp.f32(0.f);
+    mlp.f32(1.f); mlp.f32(1.f);
+    mlp.u32(2); mlp.label("left"); mlp.label("right");
+    mlp.u32(2);
+    mlp.u32(2); mlp.u32(2);
+    mlp.f32(1.f); mlp.f32(-1.f); mlp.f32(-1.f); mlp.f32(1.f);
+    mlp.f32(0.f); mlp.f32(0.f);
+    mlp.u32(2); mlp.u32(2);
+    mlp.f32(1.f); mlp.f32(0.f); mlp.f32(0.f); mlp.f32(1.f);
+    mlp.f32(0.f); mlp.f32(0.f);
+    assert(model.loadFromMemory(mlp.bytes.data(), mlp.bytes.size()));
+    assert(model.kind() == sc::NativeModel::Kind::Mlp);
+    assert(model.predict({{3.f, 1.f}}) == "left");
+    assert(model.predict({{1.f, 3.f}}) == "right");
+
+    // Truncated files are rejected.
+    assert(!model.loadFromMemory(mlp.bytes.data(), mlp.bytes.size() - 3));
+    assert(!model.loaded());
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "core/input/InputManager.hpp"
+#include "core/recognition/GlyphRasterizer.hpp"
+#include "core/recognition/ShapeDescriptors.hpp"
+#include "utils/Span.hpp"
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+int main() {
+    // Span views vectors and arrays and narrows with subspan().
+    std::vector<int> values{1, 2, 3, 4};
+    sc::Span<const int> span = values;
+    assert(span.size() == 4 && span.front() == 1 && span.back() == 4);
+    assert(span.subspan(1, 2).size() == 2 && span.subspan(1, 2)[0] == 2);
+    assert(span.subspan(3).size() == 1 && span.subspan(9).empty());
+    float array[3] = {0.f, 1.f, 2.f};
+    sc::Span<float> mutableSpan = array;
+    mutableSpan[1] = 5.f;
+    assert(array[1] == 5.f);
+
+    // PointView reads an array of Points with stride 2.
+    std::vector<sc::Point> aos{{0.f, 1.f}, {2.f, 3.f}, {4.f, 5.f}};
+    sc::PointView aosView = aos;
+    assert(aosView.size() == 3 && aosView.x(1) == 2.f && aosView.y(2) == 5.f);
+    assert(aosView.subview(1).front().x == 2.f && aosView.subview(1).size() == 2);
+    float sumY = 0.f;
+    for (const sc::Point p : aosView)
+        sumY += p.y;
+    assert(sumY == 9.f);
+
+    // PointBuffer starts inline and moves every column to one heap block.
+    sc::PointBuffer buffer;
+    assert(buffer.capacity() == sc::PointBuffer::kInlineCapacity && !buffer.onHeap());
+    const size_t count = sc::PointBuffer::kInlineCapacity * 4 + 5;
+    for (size_t i = 0; i < count; ++i)
+        buffer.push_back(static_cast<float>(i), static_cast<float>(2 * i), 1000 + i, 0.5f,
+                         static_cast<uint32_t>(i / 100));
+    assert(buffer.size() == count && buffer.onHeap());
+    assert(buffer.x()[count - 1] == static_cast<float>(count - 1));
+    assert(buffer.y()[10] == 20.f && buffer.timestamps()[10] == 1010);
+    assert(buffer.pressure()[count - 1] == 0.5f && buffer.strokeIds()[250] == 2);
+    assert(buffer.strokeRange(1) == std::make_pair(size_t{100}, size_t{200}));
+    assert(buffer.stroke(2).size() == 61 && buffer.stroke(2).front().x == 200.f);
+    assert(buffer.stroke(7).empty());
+
+    sc::PointBuffer copy = buffer;
+    assert(copy.size() == count && copy.y()[count - 1] == buffer.y()[count - 1]);
+    const size_t capacity = buffer.capacity();
+    buffer.clear();
+    assert(buffer.empty() && buffer.capacity() == capacity);
+    sc::PointBuffer moved = std::move(copy);
+    assert(moved.size() == count && copy.empty());
+
+    sc::PointBuffer small;
+    small.push_back(1.f, 2.f);
+    sc::PointBuffer smallMoved = std::move(small);
+    assert(smallMoved.size() == 1 && smallMoved.back().y == 2.f && !smallMoved.onHeap());
+
+    // InputManager keeps strokes, timestamps and pressure in one buffer and
+    // recognizers read it in place.
+    sc::InputManager mgr;
+    mgr.startCapture();
+    const uint32_t first = mgr.beginStroke();
+    mgr.addPoint(0.f, 0.f, 10, 0.25f);
+    mgr.addPoint(10.f, 0.f, 20);
+    const uint32_t second = mgr.beginStroke();
+    assert(second == first + 1 && mgr.strokeId() == second);
+    mgr.addPoint(10.f, 10.f, 30);
+    mgr.addPoint(0.f, 10.f, 40);
+    mgr.addPoint(0.f, 0.f, 50);
+    const sc::PointBuffer& captured = mgr.buffer();
+    assert(captured.size() == 5 && captured.pressure()[0] == 0.25f);
+    assert(captured.timestamps()[4] == 50);
+    assert(captured.stroke(first).size() == 2 && captured.stroke(second).size() == 3);
+
+    std::vector<sc::Point> flat = mgr.points().toVector();
+    sc::ShapeScratch scratch;
+    const sc::ShapeDescriptors fromView = sc::describeShape(mgr.points(), scratch);
+    const sc::ShapeDescriptors fromVector = sc::describeShape(flat, scratch);
+    assert(fromView.hullSize == fromVector.hullSize && fromView.cx == fromVector.cx);
+
+    // Rasterizing the buffer by stroke id matches rasterizing copies.
+    std::vector<std::vector<sc::Point>> strokes{captured.stroke(first).toVector(),
+                                                captured.stroke(second).toVector()};
+    sc::GlyphRasterOptions options;
+    options.size = 48;
+    sc::GlyphRasterizer fromBuffer;
+    sc::GlyphRasterizer fromCopies;
+    assert(fromBuffer.rasterize(captured, options) == fromCopies.rasterize(strokes, options));
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "core/recognition/RecognizerRouter.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+int main() {
+    // Native 1-NN model with a single label, so it disagrees with the
+    // heuristic primary on every gesture.
+    {
+        std::ofstream out("shadow-candidate.scm", std::ios::binary);
+        auto u32 = [&](uint32_t v) {
+            for (int i = 0; i < 4; ++i)
+                out.put(static_cast<char>((v >> (8 * i)) & 0xff));
+        };
+        auto f32 = [&](float f) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            u32(bits);
+        };
+        out << "SCNM";
+        u32(1); u32(0); u32(2);
+        f32(0.f); f32(0.f); f32(1.f); f32(1.f);
+        u32(1); u32(4); out << "blob";
+        u32(1); u32(1); f32(0.f); f32(0.f); u32(0);
+    }
+    std::remove("shadow-test.jsonl");
+
+    sc::RecognizerRouter router("missing-models.json");
+    assert(!router.setShadowModel("shape_model", "missing-candidate.scm", "shadow-test.jsonl"));
+    assert(!router.shadow());
+    assert(router.setShadowModel("shape_model", "shadow-candidate.scm", "shadow-test.jsonl"));
+
+    std::vector<sc::Point> square{{0.f,0.f},{1.f,0.f},{1.f,1.f},{0.f,1.f}};
+    for (int i = 0; i < 5; ++i)
+        assert(router.recognize(square) == "square");
+    // Gestures routed to other models are not shadowed.
+    router.recognize(sc::makeWarmupGesture(16));
+
+    router.shadow()->waitIdle();
+    sc::ShadowStats stats = router.shadow()->stats();
+    assert(stats.samples == 5);
+    assert(stats.agreements == 0 && stats.agreementRate == 0.0);
+    assert(stats.candidateP99Ms >= stats.candidateP50Ms);
+
+    router.clearShadowModel(); // flushes the summary line
+    std::ifstream log("shadow-test.jsonl");
+    std::string line;
+    int disagreements = 0;
+    int summaries = 0;
+    while (std::getline(log, line)) {
+        if (line.find("\"type\":\"disagreement\"") != std::string::npos) {
+            assert(line.find("\"candidate\":\"blob\"") != std::string::npos);
+            ++disagreements;
+        } else if (line.find("\"type\":\"summary\"") != std::string::npos) {
+            assert(line.find("\"samples\":5") != std::string::npos);
+            ++summaries;
+        }
+    }
+    assert(disagreements == 5 && summaries == 1);
+
+    // Summaries are also written while the evaluator runs, not only when it
+    // is destroyed.
+    std::remove("shadow-test.jsonl");
+    {
+        sc::ModelRunner candidate;
+        assert(candidate.loadModel("shadow-candidate.scm"));
+        sc::ShadowEvaluator eval("shape_model", std::move(candidate), "shadow-test.jsonl", 64,
+                                 200, 2);
+        for (int i = 0; i < 5; ++i)
+            eval.submit(square, "square", 0.1);
+        eval.waitIdle();
+        std::ifstream running("shadow-test.jsonl");
+        std::vector<std::string> seen;
+        while (std::getline(running, line)) {
+            if (line.find("\"type\":\"summary\"") != std::string::npos)
+                seen.push_back(line);
+        }
+        assert(seen.size() == 2);
+        assert(seen[0].find("\"samples\":2") != std::string::npos);
+        assert(seen[1].find("\"samples\":4") != std::string::npos);
+    }
+    std::ifstream closed("shadow-test.jsonl");
+    summaries = 0;
+    while (std::getline(closed, line)) {
+        if (line.find("\"type\":\"summary\"") != std::string::npos)
+            ++summaries;
+    }
+    assert(summaries == 3);
+    return 0;
+}
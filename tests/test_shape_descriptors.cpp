@@ -0,0 +1,47 @@
+#include "core/recognition/ModelRunner.hpp"
+#include <cassert>
+#include <cmath>
+
+int main() {
+    sc::ShapeScratch scratch;
+    std::vector<sc::Point> square{{0.f,0.f},{1.f,0.f},{1.f,1.f},{0.f,1.f},{0.f,0.f}};
+    auto d = sc::describeShape(square, scratch);
+    assert(d.pointCount == 5);
+    assert(d.hullSize == 4);
+    assert(d.minX == 0.f && d.maxX == 1.f && d.minY == 0.f && d.maxY == 1.f);
+    assert(std::string(sc::classifyShape(d)) == "square");
+
+    std::vector<sc::Point> tri{{0.f,0.f},{2.f,0.f},{1.f,0.f},{1.f,2.f},{0.f,0.f}};
+    d = sc::describeShape(tri, scratch);
+    assert(d.hullSize == 3);
+    assert(sc::ModelRunner::classifyHeuristic(tri, scratch) == "triangle");
+
+    // A path that crosses itself: Melkman's hull alone misses the last
+    // corner, so describeShape() falls back to the exact hull.
+    std::vector<sc::Point> bowtie{{0.f,0.f},{10.f,10.f},{10.f,0.f},{0.f,10.f}};
+    d = sc::describeShape(bowtie, scratch);
+    assert(d.hullSize == 4);
+    assert(std::string(sc::classifyShape(d)) == "square");
+
+    std::vector<sc::Point> line{{0.f,0.f},{1.f,1.f},{2.f,2.f},{3.f,3.f}};
+    assert(sc::describeShape(line, scratch).hullSize == 2);
+
+    std::vector<sc::Point> circle;
+    for (int i = 0; i < 40; ++i) {
+        float a = 6.2831853f * i / 40.f;
+        circle.push_back({std::cos(a), std::sin(a)});
+    }
+    d = sc::describeShape(circle, scratch);
+    assert(std::fabs(d.meanRadius - 1.f) < 1e-3f);
+    assert(d.radialUniformity < 1e-3f);
+
+    // Scratch only grows; describing a smaller stroke reuses the buffer.
+    size_t cap = scratch.capacity();
+    sc::describeShape(square, scratch);
+    assert(scratch.capacity() == cap);
+
+    // Without enough scratch the hull is skipped but the rest still works.
+    d = sc::describeShape(circle.data(), circle.size(), nullptr, 0);
+    assert(d.hullSize == 0 && d.pointCount == circle.size());
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "core/input/InputEventWorker.hpp"
+#include "core/input/InputManager.hpp"
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+int main() {
+    // Capacity rounds up to a power of two; a full ring rejects and counts.
+    sc::SpscRing<int> ring(5);
+    assert(ring.capacity() == 8);
+    for (int i = 0; i < 8; ++i)
+        assert(ring.tryPush(i));
+    assert(!ring.tryPush(8));
+    assert(!ring.tryPush(9));
+    assert(ring.overflowCount() == 2);
+    assert(ring.size() == 8);
+
+    int value = -1;
+    assert(ring.tryPop(value) && value == 0);
+    assert(ring.tryPush(8));
+    std::vector<int> drained;
+    assert(ring.drain([&](int v) { drained.push_back(v); }, 3) == 3);
+    assert((drained == std::vector<int>{1, 2, 3}));
+    assert(ring.drain([&](int v) { drained.push_back(v); }) == 5);
+    assert(drained.back() == 8);
+    assert(ring.empty() && !ring.tryPop(value));
+
+    // A push with a reserve leaves that many slots for later pushes.
+    for (int i = 0; i < 6; ++i)
+        assert(ring.tryPush(i, 2));
+    assert(!ring.tryPush(6, 2) && ring.overflowCount() == 3);
+    assert(ring.tryPush(6, 1) && ring.tryPush(7) && ring.size() == 8);
+    ring.drain([](int) {});
+
+    // One producer and one consumer thread: nothing is lost or reordered
+    // when the producer retries on overflow.
+    sc::SpscRing<uint64_t> stream(64);
+    const uint64_t total = 200000;
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < total; ++i) {
+            while (!stream.tryPush(i))
+                std::this_thread::yield();
+        }
+    });
+    uint64_t expected = 0;
+    while (expected < total) {
+        const size_t drained = stream.drain([&](uint64_t v) {
+            assert(v == expected);
+            ++expected;
+        });
+        if (drained == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    assert(stream.empty());
+
+    // InputManager streams each gesture as Begin, Point..., End.
+    sc::InputEventRing events(16);
+    sc::InputManager mgr;
+    mgr.setEventRing(&events);
+    mgr.addPoint(9.f, 9.f); // not capturing: ignored
+    mgr.startCapture();
+    mgr.addPoint(1.f, 2.f);
+    mgr.addPoint(3.f, 4.f);
+    mgr.stopCapture();
+    mgr.stopCapture(); // already stopped: no second End
+    std::vector<sc::InputEvent> got;
+    events.drain([&](const sc::InputEvent& e) { got.push_back(e); });
+    assert(got.size() == 4);
+    assert(got[0].type == sc::InputEvent::Type::Begin);
+    assert(got[1].type == sc::InputEvent::Type::Point && got[1].point.x == 1.f);
+    assert(got[2].type == sc::InputEvent::Type::Point && got[2].point.y == 4.f);
+    assert(got[3].type == sc::InputEvent::Type::End);
+    assert(mgr.points().size() == 2);
+
+    // Overflow drops points, never the End that closes the gesture, and
+    // does not affect the captured points. Detaching closes the gesture.
+    mgr.startCapture();
+    for (int i = 0; i < 20; ++i)
+        mgr.addPoint(static_cast<float>(i), 0.f);
+    assert(events.overflowCount() == 6);
+    assert(mgr.points().size() == 20);
+    mgr.setEventRing(nullptr);
+    mgr.stopCapture();
+    assert(events.size() == 16);
+    got.clear();
+    events.drain([&](const sc::InputEvent& e) { got.push_back(e); });
+    assert(got.front().type == sc::InputEvent::Type::Begin);
+    assert(got.back().type == sc::InputEvent::Type::End);
+
+    // A gesture whose Begin does not fit starts at its first point that
+    // does, so gestures stay separate while the ring is full.
+    sc::InputEventRing small(4);
+    mgr.setEventRing(&small);
+    mgr.startCapture();
+    mgr.addPoint(1.f, 0.f);
+    mgr.addPoint(2.f, 0.f);
+    mgr.stopCapture(); // Begin, 1, 2, End fill the ring
+    mgr.startCapture(); // no room for Begin
+    mgr.addPoint(3.f, 0.f);
+    small.drain([](const sc::InputEvent&) {});
+    mgr.addPoint(4.f, 0.f);
+    mgr.stopCapture();
+    got.clear();
+    small.drain([&](const sc::InputEvent& e) { got.push_back(e); });
+    assert(got.size() == 3);
+    assert(got[0].type == sc::InputEvent::Type::Begin);
+    assert(got[1].type == sc::InputEvent::Type::Point && got[1].point.x == 4.f);
+    assert(got[2].type == sc::InputEvent::Type::End);
+    mgr.setEventRing(nullptr);
+
+    // A worker thread drains the ring and receives whole gestures while the
+    // producer keeps capturing.
+    {
+        sc::InputEventRing stream(64);
+        std::vector<std::vector<sc::Point>> gestures;
+        sc::InputManager input;
+        input.setEventRing(&stream);
+        sc::InputEventWorker worker(stream, [&](const sc::PointBuffer& g) {
+            gestures.push_back(g.view().toVector());
+        });
+        // Wait for room instead of losing events, like a producer that can
+        // afford to wait for the worker.
+        auto waitForRoom = [&] {
+            while (stream.size() + 3 > stream.capacity())
+                std::this_thread::yield();
+        };
+        for (int g = 0; g < 50; ++g) {
+            waitForRoom();
+            input.startCapture();
+            for (int i = 0; i < 10; ++i) {
+                waitForRoom();
+                input.addPoint(static_cast<float>(g), static_cast<float>(i));
+            }
+            input.stopCapture();
+        }
+        worker.stop();
+        assert(worker.gestureCount() == 50 && gestures.size() == 50);
+        for (size_t g = 0; g < gestures.size(); ++g) {
+            assert(gestures[g].size() == 10);
+            for (size_t i = 0; i < gestures[g].size(); ++i)
+                assert(gestures[g][i].x == static_cast<float>(g) &&
+                       gestures[g][i].y == static_cast<float>(i));
+        }
+        assert(stream.overflowCount() == 0);
+    }
+
+    // When maxPoints thins a gesture, the worker rebuilds the same points
+    // that InputManager keeps.
+    {
+        sc::InputEventRing stream(1024);
+        std::vector<sc::Point> received;
+        sc::InputManager input;
+        sc::InputFilterSettings capped;
+        capped.maxPoints = 16;
+        input.setFilterSettings(capped);
+        input.setEventRing(&stream);
+        sc::InputEventWorker worker(stream, [&](const sc::PointBuffer& g) {
+            received = g.view().toVector();
+        });
+        input.startCapture();
+        for (int i = 0; i < 100; ++i)
+            input.addPoint(static_cast<float>(i), 0.f);
+        input.stopCapture();
+        worker.stop();
+        const std::vector<sc::Point> kept = input.points().toVector();
+        assert(kept.size() < 100 && received.size() == kept.size());
+        for (size_t i = 0; i < kept.size(); ++i)
+            assert(received[i].x == kept[i].x && received[i].y == kept[i].y);
+    }
+    return 0;
+}
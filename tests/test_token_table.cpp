@@ -0,0 +1,81 @@
+#include "core/recognition/TokenTable.hpp"
+#include <cassert>
+#include <string>
+#include <vector>
+
+static void putU32(std::vector<char>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+static std::vector<char> buildTable(const std::vector<std::string>& tokens,
+                                    const std::vector<uint8_t>& flags, uint32_t start, uint32_t eos) {
+    std::vector<char> out{'S', 'C', 'T', 'K'};
+    putU32(out, 1);
+    putU32(out, static_cast<uint32_t>(tokens.size()));
+    putU32(out, start);
+    putU32(out, eos);
+    uint32_t offset = 0;
+    putU32(out, 0);
+    for (const auto& token : tokens) {
+        offset += static_cast<uint32_t>(token.size());
+        putU32(out, offset);
+    }
+    for (uint8_t flag : flags)
+        out.push_back(static_cast<char>(flag));
+    for (const auto& token : tokens)
+        out.insert(out.end(), token.begin(), token.end());
+    return out;
+}
+
+int main() {
+    // "\xe2\x82\xac" (EURO SIGN) is split across two byte-level tokens.
+    const std::vector<std::string> tokens{"<s>", "<pad>", "</s>", "hi", " there", "\xe2\x82", "\xac"};
+    const std::vector<uint8_t> flags{1, 1, 1, 0, 0, 0, 0};
+    std::vector<char> bytes = buildTable(tokens, flags, 0, 2);
+
+    sc::TokenTable table;
+    assert(table.loadFromMemory(bytes.data(), bytes.size()));
+    assert(table.loaded());
+    assert(table.size() == tokens.size());
+    assert(table.startToken() == 0);
+    assert(table.eosToken() == 2);
+    assert(table.isSpecial(1));
+    assert(!table.isSpecial(3));
+    assert(table.tokenBytes(4) == " there");
+    assert(table.tokenBytes(0).empty());
+
+    // Special and out-of-range ids are skipped; split characters are joined.
+    assert(table.decode({0, 3, 4, 5, 6, 2, 99}) == U"hi there\u20AC");
+    assert(table.decode({}).empty());
+    // Whole tokens are precomputed; fragments are left to the byte path.
+    assert(table.tokenText(4) == U" there");
+    assert(table.tokenText(2).empty());
+    assert(!table.isPartial(3));
+    assert(table.isPartial(5) && table.isPartial(6));
+    assert(table.tokenText(5).empty());
+    assert(table.decode({3, 4}) == U"hi there");
+    assert(table.decode({4, 3, 3}) == U" therehihi");
+
+    // A lone fragment decodes to replacement characters.
+    assert(table.decode({5}) == U"\uFFFD\uFFFD");
+
+    // Malformed tables are rejected.
+    std::vector<char> badMagic = bytes;
+    badMagic[0] = 'X';
+    assert(!table.loadFromMemory(badMagic.data(), badMagic.size()));
+    assert(!table.loaded());
+    std::vector<char> truncated(bytes.begin(), bytes.end() - 2);
+    assert(!table.loadFromMemory(truncated.data(), truncated.size()));
+    std::vector<char> badEos = buildTable(tokens, flags, 0, 7);
+    assert(!table.loadFromMemory(badEos.data(), badEos.size()));
+    std::vector<char> badOffsets = bytes;
+    badOffsets[20 + 4 * 4] = 0x7f; // offsets[4] beyond offsets[5]
+    assert(!table.loadFromMemory(badOffsets.data(), badOffsets.size()));
+
+    // UTF-8 decoding rejects overlong forms, surrogates and bad continuations.
+    const std::string mixed = "a\xc3\xa9\xf0\x9f\x98\x80\xc0\xaf\xed\xa0\x80\xe2\x28";
+    assert(sc::utf8ToUtf32(mixed.data(), mixed.size()) ==
+           U"a\u00E9\U0001F600\uFFFD\uFFFD\uFFFD\uFFFD\uFFFD\uFFFD(");
+    return 0;
+}
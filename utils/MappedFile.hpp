@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(__APPLE__)
+#  include <fcntl.h>
+#  include <mach/mach.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <fstream>
+#endif
+
+namespace sc {
+
+// Read-only memory mapping of a whole file. The mapping is released when
+// the object is destroyed; it is neither copyable nor movable so pointers
+// into it stay valid for its lifetime.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return;
+        m_opened = true;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart <= 0)
+            return;
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+            return;
+        m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        m_fd = ::open(path.c_str(), O_RDONLY);
+        if (m_fd < 0)
+            return;
+        m_opened = true;
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0 || st.st_size <= 0)
+            return;
+        m_size = static_cast<size_t>(st.st_size);
+        void* ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (ptr != MAP_FAILED)
+            m_data = ptr;
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+#else
+        if (m_data)
+            ::munmap(m_data, m_size);
+        if (m_fd >= 0)
+            ::close(m_fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // True when the file could be opened, even if it was empty or the
+    // mapping failed.
+    bool opened() const { return m_opened; }
+    bool valid() const { return m_data != nullptr; }
+    const void* data() const { return m_data; }
+    size_t size() const { return valid() ? m_size : 0; }
+
+    // Bytes of the mapping currently resident in physical memory. Windows
+    // has no cheap per-range query, so the whole view is reported there.
+    size_t residentBytes() const {
+        if (!m_data)
+            return 0;
+#ifdef _WIN32
+        return m_size;
+#else
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t pages = (m_size + page - 1) / page;
+#  ifdef __APPLE__
+        std::vector<char> vec(pages);
+#  else
+        std::vector<unsigned char> vec(pages);
+#  endif
+        if (::mincore(m_data, m_size, vec.data()) != 0)
+            return 0;
+        size_t resident = 0;
+        for (size_t i = 0; i < pages; ++i) {
+            if (vec[i] & 1)
+                resident += page;
+        }
+        return resident < m_size ? resident : m_size;
+#endif
+    }
+
+private:
+    void* m_data{nullptr};
+    size_t m_size{0};
+    bool m_opened{false};
+#ifdef _WIN32
+    HANDLE m_file{INVALID_HANDLE_VALUE};
+    HANDLE m_mapping{nullptr};
+#else
+    int m_fd{-1};
+#endif
+};
+
+// Resident set size of the current process in bytes, or 0 if unknown.
+inline size_t processResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<size_t>(counters.WorkingSetSize);
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return 0;
+    return static_cast<size_t>(info.resident_size);
+#else
+    std::ifstream statm("/proc/self/statm");
+    size_t total = 0;
+    size_t resident = 0;
+    if (!(statm >> total >> resident))
+        return 0;
+    return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+} // namespace sc
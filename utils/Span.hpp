@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace sc {
+
+// Non-owning view of a contiguous array, for C++17 code that cannot use
+// std::span. Span<const T> binds to vectors and arrays implicitly.
+template <typename T>
+class Span {
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    constexpr Span() = default;
+    constexpr Span(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    template <size_t N>
+    constexpr Span(T (&array)[N]) : m_data(array), m_size(N) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    Span(std::vector<U>& vec) : m_data(vec.data()), m_size(vec.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible<const U*, T*>::value>>
+    Span(const std::vector<U>& vec) : m_data(vec.data()), m_size(vec.size()) {}
+
+    // Span<T> converts to Span<const T>.
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    constexpr Span(const Span<U>& other) : m_data(other.data()), m_size(other.size()) {}
+
+    constexpr T* data() const { return m_data; }
+    constexpr size_t size() const { return m_size; }
+    constexpr bool empty() const { return m_size == 0; }
+    constexpr T& operator[](size_t i) const { return m_data[i]; }
+    constexpr T& front() const { return m_data[0]; }
+    constexpr T& back() const { return m_data[m_size - 1]; }
+    constexpr iterator begin() const { return m_data; }
+    constexpr iterator end() const { return m_data + m_size; }
+
+    // Elements [offset, offset + count), clamped to the span.
+    constexpr Span subspan(size_t offset, size_t count = static_cast<size_t>(-1)) const {
+        if (offset > m_size)
+            offset = m_size;
+        if (count > m_size - offset)
+            count = m_size - offset;
+        return Span(m_data + offset, count);
+    }
+
+private:
+    T* m_data{nullptr};
+    size_t m_size{0};
+};
+
+} // namespace sc